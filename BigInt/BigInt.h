@@ -1,15 +1,27 @@
 #pragma once
 
-#include "int_type.h"
-#include "exceptions.h"
-#include "ExpandingVector.h"
-#include <bitset>
-
 #ifdef _DEBUG
 #define _BIGINT_EXCEPTIONS_
 #define _BIGINT_MEMCHECK_
 #endif
 
+#include "int_type.h"
+#include "exceptions.h"
+#include "ExpandingVector.h"
+#include "multiplication.h"
+#include "division.h"
+#include "radix.h"
+#include "gcd.h"
+#include <bit>
+#include <bitset>
+#include <charconv>
+#include <concepts>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
 #ifdef _BIGINT_EXCEPTIONS_
 #define BIGINT_NOEXCEPT noexcept(false)
 
@@ -21,48 +33,60 @@ namespace math
 {
 	class BigInt
 	{
+		friend class MontgomeryContext;
+		friend class BarrettContext;
+		friend class BigSInt;
+
 	private:
 		ExpandingVector m_data;
 
 	public:
 		BigInt() noexcept = default;
 
-		BigInt(std::string sNumber) BIGINT_NOEXCEPT
+		// hex with a 0x prefix, binary with 0b, decimal otherwise
+		BigInt(std::string_view svNumber) BIGINT_NOEXCEPT
 		{
 			auto toLowerCase = [](char c) -> char
 			{
 				return c | 0b00100000;
 			};
 
-			// hex
-			if (sNumber[0] == '0' && toLowerCase(sNumber[1]) == 'x')
-			{
-				sNumber = sNumber.substr(2);
-				uint64_t i = sNumber.size();
-				uint64_t count = 0;
+			unsigned nDigitBits = 0;
+			if (svNumber.size() >= 2 && svNumber[0] == '0' && toLowerCase(svNumber[1]) == 'x')
+				nDigitBits = 4;
+			else if (svNumber.size() >= 2 && svNumber[0] == '0' && toLowerCase(svNumber[1]) == 'b')
+				nDigitBits = 1;
 
-				while (i-- != 0)
-				{
-					uint8_t  quarterWord = getQuarterWord(sNumber.at(i));
-					uint64_t nBlockOffset = (count % 16) / 2;
-					uint64_t nBlockIndex = count / 16;
-					bool bOffset = !(count & 1);
-
-					setQuarterWord(quarterWord, nBlockIndex, nBlockOffset, bOffset);
-
-					count++;
-				}
-			}
-			// binary
-			else if (sNumber[0] == '0' && toLowerCase(sNumber[1]) == 'b')
+			[[maybe_unused]] bool bValid;
+			if (nDigitBits)
 			{
+				svNumber.remove_prefix(2);
+				m_data.resize(radix::pow2Limbs(svNumber.size(), nDigitBits));
+				bValid = radix::parsePow2(m_data.data(), svNumber.data(), svNumber.size(), nDigitBits);
 			}
-			// decimal
 			else
 			{
+				m_data.resize(radix::decimalLimbs(svNumber.size()));
+				bValid = radix::parseDecimal(m_data.data(), svNumber.data(), svNumber.size());
+				m_data.resize(std::max<size_t>(usedSize(), 1));
 			}
+
+#ifdef _BIGINT_EXCEPTIONS_
+			if (!bValid)
+				throw error::unrecognized_char{};
+#endif
 		}
 
+		BigInt(const std::string &sNumber) BIGINT_NOEXCEPT
+			: BigInt(std::string_view(sNumber))
+		{}
+
+		// a plain const char * overload would make the literal 0 ambiguous
+		template <typename Char> requires std::same_as<Char, char>
+		BigInt(const Char *szNumber) BIGINT_NOEXCEPT
+			: BigInt(std::string_view(szNumber))
+		{}
+
 		BigInt(int_t rhs) noexcept
 		{
 			setBlock(0, rhs);
@@ -88,123 +112,44 @@ namespace math
 			setBlock(nBlockIndex, block);
 		}
 
-		static constexpr uint8_t getQuarterWord(char c) BIGINT_NOEXCEPT
-		{
-			if (c >= '0' && c <= '9')
-				return c - '0' + 0x0;
-			else if (c >= 'a' && c <= 'f')
-				return c - 'a' + 0xa;
-#ifdef _BIGINT_EXCEPTIONS_
-			throw error::unrecognized_char{};
-#else
-			return 0;
-#endif
-		}
-
-		void setQuarterWord(const uint8_t &nQuarterWord, const uint64_t &nBlockIndex, const uint64_t &nBlockOffset, const bool &bOffset) noexcept
-		{
-			int_t b = getBlockCheck(nBlockIndex);
-			int_t output = b;
-
-			if (bOffset)
-			{
-				uint8_t mask = b.u8[nBlockOffset] & 0xF0;
-				output.u8[nBlockOffset] = mask | (nQuarterWord & 0x0F);
-			}
-			else
-			{
-				uint8_t mask = b.u8[nBlockOffset] & 0x0F;
-				output.u8[nBlockOffset] = mask | (nQuarterWord << 4);
-			}
-
-			setBlock(nBlockIndex, output);
-		}
-
-		static uint32_t saveAdd(const uint32_t a, const uint32_t b, uint32_t &carry) noexcept
-		{
-			uint64_t result = (uint64_t)a + (uint64_t)b + (uint64_t)carry;
-			carry = result >> 32;
-
-			return static_cast<uint32_t>(result);
-		};
-
 		void twosComplement() noexcept
 		{
-			for (uint64_t i = 0; i < m_data.size(); i++)
-			{
-				int_t data = getBlock(i);
-				data.u64 = ~data.u64;
-				setBlock(i, data);
-			}
+			int_t *p = m_data.data();
+			for (size_t i = 0; i < m_data.size(); i++)
+				p[i] = ~p[i].u64;
 
-			uint32_t carry = 1;
-
-			for (uint64_t nBlock = 0; nBlock < m_data.size(); nBlock++)
-			{
-				for (uint64_t nOffset = 0; nOffset < 2; nOffset++)
-				{
-					int_t block = getBlock(nBlock);
-					block.u32[nOffset] = saveAdd(getBlock(nBlock).u32[nOffset], 0, carry);
-					setBlock(nBlock, block);
-				}
-			}
+			kernel::add_1(p, p, m_data.size(), 1);
 		}
 
-		void addOffset(const int_t value, const uint64_t offset) noexcept
+		[[nodiscard]] size_t getMinUsedSize(const BigInt &rhs) const noexcept
 		{
-			auto internalAddOffset = [&](const uint32_t c, const uint64_t offset) -> void
-			{
-				uint32_t carry = c;
-				uint64_t i = offset;
-				for (uint64_t i = offset; carry != 0; i++)
-				{
-					int_t block = getBlock(i / 2);
-					block.u32[i % 2] = saveAdd(block.u32[i % 2], 0, carry);
-					setBlock(i / 2, block);
-				}
-			};
-
-			internalAddOffset(value.u32[0], offset);
-			internalAddOffset(value.u32[1], offset + 1);
+			size_t nOwnUsedSize = usedSize();
+			size_t nRhsUsedSize = rhs.usedSize();
+			return std::min(nOwnUsedSize, nRhsUsedSize);
 		}
 
-		void shift_left_set_last_bit(bool bit) noexcept
+		// -1, 0 or 1 like memcmp
+		[[nodiscard]] int compare(const BigInt &rhs) const noexcept
 		{
-			int_t carry = bit;
-			uint64_t i = 0;
-			do
-			{
-				int_t thisBlock = getBlock(i);
-				setBlock(i, thisBlock << 1Ui64 | carry);
-				carry = thisBlock >> 63Ui64;
-				i++;
-			} while (i < m_data.size());
+			const size_t nOwnUsedSize = usedSize();
+			const size_t nRhsUsedSize = rhs.usedSize();
 
-			carryCorrect(carry.u32[0]);
+			if (nOwnUsedSize != nRhsUsedSize)
+				return nOwnUsedSize < nRhsUsedSize ? -1 : 1;
+			return kernel::cmp(m_data.data(), rhs.m_data.data(), nOwnUsedSize);
 		}
 
-		void setBit(const size_t nBlockIndex, const size_t nBitIndex) noexcept
+		void carryCorrect(const uint64_t carry) noexcept
 		{
-			int_t block = getBlockCheck(nBlockIndex);
-			block.u64 |= (uint64_t(1) << nBitIndex);
-			setBlock(nBlockIndex, block);
-		}
-
-		[[nodiscard]] size_t getMinUsedSize(const BigInt &rhs) const noexcept
-		{
-			size_t nOwnUsedSize = usedSize();
-			size_t nRhsUsedSize = rhs.usedSize();
-			return std::min(nOwnUsedSize, nRhsUsedSize);
+			if (carry)
+				m_data.setBlock(m_data.size(), carry);
 		}
 
-		void carryCorrect(const uint32_t carry) noexcept
+		// a borrow out of the top limb wraps around at the width of the wider operand
+		void borrowCorrect(const uint64_t borrow, const size_t nWidth) noexcept
 		{
-			if (carry)
-			{
-				int_t block{};
-				block.u32[0] = carry;
-				m_data.setBlock(m_data.size(), block);
-			}
+			if (borrow)
+				m_data.shrink_to(std::max(nWidth, (size_t)1));
 		}
 
 		[[nodiscard]] size_t usedSize() const noexcept
@@ -251,45 +196,207 @@ namespace math
 			return m_data.size();
 		}
 
-	public:
-		friend std::ostream &operator<<(std::ostream &os, const BigInt &i) noexcept
+		[[nodiscard]] size_t getBitCount() const noexcept
 		{
-			os << "0x";
-			bool bWriteNeeded = false;
+			const size_t nUsedSize = usedSize();
+			if (nUsedSize == 0) return 0;
+
+			return nUsedSize * 64 - std::countl_zero(getBlock(nUsedSize - 1).u64);
+		}
 
-			for (int64_t idx = i.m_data.size() - 1; idx >= 0; idx--)
+		[[nodiscard]] bool getBit(const size_t nBit) const noexcept
+		{
+			return getBlockCheck(nBit / 64).u64 >> (nBit % 64) & 1;
+		}
+
+	public: // binary import and export
+		static_assert(sizeof(int_t) == sizeof(uint64_t) && alignof(int_t) == alignof(uint64_t), "limbs are exchanged as uint64_t");
+
+		// base 256 digits in the given byte order
+		[[nodiscard]] static BigInt fromBytes(const std::span<const uint8_t> bytes, const std::endian order = std::endian::little) noexcept
+		{
+			BigInt out;
+			out.m_data.resize(std::max<size_t>((bytes.size() + 7) / 8, 1));
+			radix::fromBytes(out.m_data.data(), bytes.data(), bytes.size(), order);
+			return out;
+		}
+
+		// bytes needed by toBytes, 0 for zero
+		[[nodiscard]] size_t getByteCount() const noexcept
+		{
+			return radix::byteSize(m_data.data(), m_data.size());
+		}
+
+		// writes the value zero padded to all of out, returns false if it needs more bytes
+		bool toBytes(const std::span<uint8_t> out, const std::endian order = std::endian::little) const noexcept
+		{
+			if (getByteCount() > out.size())
+				return false;
+
+			radix::toBytes(out.data(), out.size(), m_data.data(), m_data.size(), order);
+			return true;
+		}
+
+		// little endian limbs
+		[[nodiscard]] static BigInt fromLimbs(const std::span<const uint64_t> limbs) noexcept
+		{
+			BigInt out;
+			out.m_data.resize(std::max<size_t>(limbs.size(), 1));
+			std::copy(limbs.begin(), limbs.end(), reinterpret_cast<uint64_t *>(out.m_data.data()));
+			return out;
+		}
+
+		// the used limbs in place, valid until the value is modified
+		[[nodiscard]] std::span<const uint64_t> limbs() const noexcept
+		{
+			return { reinterpret_cast<const uint64_t *>(m_data.data()), usedSize() };
+		}
+
+		// takes ownership of pLimbs[0, nCapacity) holding nSize limbs without copying. the buffer has to
+		// come from pResource->allocate(nCapacity * sizeof(uint64_t), alignof(uint64_t))
+		[[nodiscard]] static BigInt adopt(uint64_t *pLimbs, const size_t nSize, const size_t nCapacity, std::pmr::memory_resource *pResource = memory::resource()) noexcept
+		{
+			BigInt out;
+			out.m_data.adopt(reinterpret_cast<int_t *>(pLimbs), nSize, nCapacity, pResource);
+			return out;
+		}
+
+		// wire format: the byte count as LEB128 followed by that many little endian bytes
+		void serialize(std::ostream &os) const noexcept
+		{
+			const size_t nBytes = getByteCount();
+			uint8_t aLength[10];
+			size_t nLength = 0;
+			for (size_t n = nBytes; ; n >>= 7)
 			{
-				int_t val = i.getBlock(idx);
+				aLength[nLength++] = uint8_t(n & 0x7f) | (n > 0x7f ? 0x80 : 0);
+				if (n <= 0x7f)
+					break;
+			}
+			os.write(reinterpret_cast<const char *>(aLength), std::streamsize(nLength));
+
+			if (std::endian::native == std::endian::little)
+				os.write(reinterpret_cast<const char *>(m_data.data()), std::streamsize(nBytes));
+			else
+			{
+				memory::vector<uint8_t> vBytes(nBytes, memory::resource());
+				toBytes(vBytes, std::endian::little);
+				os.write(reinterpret_cast<const char *>(vBytes.data()), std::streamsize(nBytes));
+			}
+		}
 
-				if (bWriteNeeded || val.u64 != 0 || idx == 0)
+		// reads a value written by serialize, sets the failbit and returns 0 on malformed input. the limbs
+		// grow with the bytes that actually arrive, so a bogus length can't allocate more than the stream holds
+		[[nodiscard]] static BigInt deserialize(std::istream &is) noexcept
+		{
+			size_t nBytes = 0;
+			for (unsigned nShift = 0; ; nShift += 7)
+			{
+				const int c = is.get();
+				// the tenth byte holds bit 63 only
+				if (c == std::char_traits<char>::eof() || nShift >= 64 || (nShift == 63 && (c & 0x7e) != 0))
 				{
-					os << std::setw(16) << std::hex << std::setfill('0') << val.u64;
-					bWriteNeeded = true;
+					is.setstate(std::ios::failbit);
+					return BigInt(0);
 				}
+
+				nBytes |= size_t(c & 0x7f) << nShift;
+				if ((c & 0x80) == 0)
+					break;
 			}
 
-			return os;
+			constexpr size_t nChunkBytes = 4096;
+			uint8_t aChunk[nChunkBytes];
+
+			BigInt out;
+			out.m_data.resize(1);
+			for (size_t nDone = 0; nDone < nBytes;)
+			{
+				const size_t nChunk = std::min(nBytes - nDone, nChunkBytes);
+				is.read(reinterpret_cast<char *>(aChunk), std::streamsize(nChunk));
+				if (size_t(is.gcount()) != nChunk)
+				{
+					is.setstate(std::ios::failbit);
+					return BigInt(0);
+				}
+
+				// every chunk but the last is a whole number of limbs
+				out.m_data.resize((nDone + nChunk + 7) / 8);
+				radix::fromBytes(out.m_data.data() + nDone / 8, aChunk, nChunk, std::endian::little);
+				nDone += nChunk;
+			}
+			return out;
+		}
+
+	public:
+		// digits in base 2 to 36 without prefix or leading zeros, see std::to_chars. bases that aren't
+		// powers of two allocate scratch for the conversion
+		friend std::to_chars_result to_chars(char *first, char *last, const BigInt &value, const int nBase = 10) noexcept
+		{
+			return radix::toChars(first, last, value.m_data.data(), value.m_data.size(), unsigned(nBase));
+		}
+
+		friend std::string to_string(const BigInt &value, const int nBase = 10) noexcept
+		{
+			// about bit_width / log2(nBase) characters, so that toChars can write in place
+			const size_t nChars = nBase >= 2 && nBase <= 36 ? radix::maxChars(value.m_data.data(), value.m_data.size(), unsigned(nBase)) : 1;
+			std::string sDigits(nChars, '\0');
+			const std::to_chars_result result = to_chars(sDigits.data(), sDigits.data() + sDigits.size(), value, nBase);
+			sDigits.resize(result.ec == std::errc{} ? size_t(result.ptr - sDigits.data()) : 0);
+			return sDigits;
+		}
+
+		friend std::ostream &operator<<(std::ostream &os, const BigInt &i) noexcept
+		{
+			return os << "0x" << to_string(i, 16);
+		}
+
+	public:
+		// greatest common divisor, gcd(a, 0) = a
+		[[nodiscard]] friend BigInt gcd(const BigInt &a, const BigInt &b) noexcept
+		{
+			const size_t nSize = std::max({ a.usedSize(), b.usedSize(), (size_t)1 });
+
+			BigInt out;
+			out.m_data.resize(nSize);
+			const size_t nUsedSize = euclid::gcd(out.m_data.data(), a.m_data.data(), a.usedSize(), b.m_data.data(), b.usedSize());
+			out.m_data.shrink_to(std::max(nUsedSize, (size_t)1));
+			return out;
+		}
+
+		// the inverse of a modulo m in [0, m), nothing if gcd(a, m) != 1 or m is 0
+		[[nodiscard]] friend std::optional<BigInt> modinv(const BigInt &a, const BigInt &m) noexcept
+		{
+			const size_t nModulusSize = m.usedSize();
+			if (nModulusSize == 0)
+				return std::nullopt;
+			if (m == 1)
+				return BigInt(0);
+
+			BigInt out;
+			out.m_data.resize(nModulusSize);
+			if (!euclid::modinv(out.m_data.data(), a.m_data.data(), a.usedSize(), m.m_data.data(), nModulusSize))
+				return std::nullopt;
+			return out;
 		}
 
 	public: // +; +=; ++
 		[[nodiscard]] BigInt operator+(const BigInt &rhs) const noexcept
 		{
-			size_t nMaxSize = std::max(usedSize(), rhs.usedSize());
+			const size_t nOwnUsedSize = usedSize();
+			const size_t nRhsUsedSize = rhs.usedSize();
+			const bool bOwnLonger = nOwnUsedSize >= nRhsUsedSize;
+			const int_t *pLong = bOwnLonger ? m_data.data() : rhs.m_data.data();
+			const int_t *pShort = bOwnLonger ? rhs.m_data.data() : m_data.data();
+			const size_t nLong = std::max(nOwnUsedSize, nRhsUsedSize);
+			const size_t nShort = std::min(nOwnUsedSize, nRhsUsedSize);
 
 			BigInt out;
-			out.m_data.resize(std::max(nMaxSize, size_t(1)));
-			
-			uint32_t carry = 0;
-			for (uint64_t nBlock = 0; nBlock < nMaxSize; nBlock++)
-			{
-				for (uint64_t nOffset = 0; nOffset < 2; nOffset++)
-				{
-					int_t block = out.getBlock(nBlock);
-					block.u32[nOffset] = saveAdd(getBlockCheck(nBlock).u32[nOffset], rhs.getBlockCheck(nBlock).u32[nOffset], carry);
-					out.setBlock(nBlock, block);
-				}
-			}
+			out.m_data.resize(std::max(nLong, size_t(1)));
 
+			int_t *p = out.m_data.data();
+			uint64_t carry = kernel::add_n(p, pLong, pShort, nShort);
+			carry = kernel::add_1(p + nShort, pLong + nShort, nLong - nShort, carry);
 			out.carryCorrect(carry);
 			
 			return out;
@@ -297,7 +404,16 @@ namespace math
 
 		BigInt &operator+=(const BigInt &rhs) noexcept
 		{
-			return *this = *this + rhs;
+			const size_t nRhsUsedSize = rhs.usedSize();
+			if (m_data.size() < nRhsUsedSize)
+				m_data.resize(nRhsUsedSize);
+
+			int_t *p = m_data.data();
+			uint64_t carry = kernel::add_n(p, p, rhs.m_data.data(), nRhsUsedSize);
+			carry = kernel::add_1(p + nRhsUsedSize, p + nRhsUsedSize, m_data.size() - nRhsUsedSize, carry);
+			carryCorrect(carry);
+
+			return *this;
 		}
 
 		BigInt &operator++() noexcept
@@ -307,43 +423,35 @@ namespace math
 
 		const BigInt operator++(int) noexcept
 		{
-			return *this += (int_t)1;
+			BigInt old = *this;
+			*this += (int_t)1;
+			return old;
 		}
 
 		[[nodiscard]] BigInt operator+(const int_t rhs) const noexcept
 		{
-			BigInt out;
-			out.m_data.resize(std::max(usedSize(), (size_t)1));
-			
-			uint32_t carry = 0;
+			BigInt out = *this;
+			out += rhs;
+			return out;
+		}
 
-			// add first 8 bytes
-			for (uint64_t nOffset = 0; nOffset < 2; nOffset++)
-			{
-				int_t block = out.getBlock(0);
-				block.u32[nOffset] = saveAdd(getBlock(0).u32[nOffset], rhs.u32[nOffset], carry);
-				out.setBlock(0, block);
-			}
-			
-			// add the rest
-			for (uint64_t nBlock = 1; nBlock < out.m_data.size(); nBlock++)
-			{
-				for (uint64_t nOffset = 0; nOffset < 2; nOffset++)
-				{
-					int_t block = getBlock(nBlock);
-					block.u32[nOffset] = saveAdd(getBlock(nBlock).u32[nOffset], 0, carry);
-					out.setBlock(nBlock, block);
-				}
-			}
+		BigInt &operator+=(const int_t rhs) noexcept
+		{
+			if (m_data.size() == 0)
+				m_data.resize(1);
 
-			out.carryCorrect(carry);
+			carryCorrect(kernel::add_1(m_data.data(), m_data.data(), m_data.size(), rhs.u64));
+			return *this;
+		}
 
-			return out;
+		[[nodiscard]] BigInt operator+(const uint64_t rhs) const noexcept
+		{
+			return *this + int_t(rhs);
 		}
 
-		BigInt &operator+=(const int_t rhs) noexcept
+		BigInt &operator+=(const uint64_t rhs) noexcept
 		{
-			return *this = *this + rhs;
+			return *this += int_t(rhs);
 		}
 
 	public: // +; -
@@ -360,34 +468,37 @@ namespace math
 		}
 
 	public: // -; -=; --
+		// wraps around at the width of the wider operand if rhs is the larger one
 		[[nodiscard]] BigInt operator-(const BigInt &rhs) const noexcept
 		{
-			size_t nMaxSize = std::max(usedSize(), rhs.usedSize());
-
-			BigInt v = rhs;
-			v.m_data.resize(std::max(nMaxSize, (size_t)1));
-			v.twosComplement();
+			const size_t nOwnUsedSize = usedSize();
+			const size_t nRhsUsedSize = rhs.usedSize();
+			const size_t nMaxSize = std::max(nOwnUsedSize, nRhsUsedSize);
 
 			BigInt out;
-			out.m_data.resize(nMaxSize);
+			out.m_data.resize(std::max(nMaxSize, (size_t)1));
 
-			uint32_t carry = 0;
-			for (uint64_t nBlock = 0; nBlock < nMaxSize; nBlock++)
-			{
-				for (uint64_t nOffset = 0; nOffset < 2; nOffset++)
-				{
-					int_t block = out.getBlock(nBlock);
-					block.u32[nOffset] = saveAdd(getBlock(nBlock).u32[nOffset], v.getBlock(nBlock).u32[nOffset], carry);
-					out.setBlock(nBlock, block);
-				}
-			}
+			int_t *p = out.m_data.data();
+			std::copy(m_data.data(), m_data.data() + nOwnUsedSize, p);
+			const uint64_t borrow = kernel::sub_n(p, p, rhs.m_data.data(), nRhsUsedSize);
+			kernel::sub_1(p + nRhsUsedSize, p + nRhsUsedSize, nMaxSize - nRhsUsedSize, borrow);
 
 			return out;
 		}
 
 		BigInt &operator-=(const BigInt &rhs) noexcept
 		{
-			return *this = *this - rhs;
+			const size_t nOwnUsedSize = usedSize();
+			const size_t nRhsUsedSize = rhs.usedSize();
+			if (m_data.size() < nRhsUsedSize)
+				m_data.resize(nRhsUsedSize);
+
+			int_t *p = m_data.data();
+			uint64_t borrow = kernel::sub_n(p, p, rhs.m_data.data(), nRhsUsedSize);
+			borrow = kernel::sub_1(p + nRhsUsedSize, p + nRhsUsedSize, m_data.size() - nRhsUsedSize, borrow);
+			borrowCorrect(borrow, std::max(nOwnUsedSize, nRhsUsedSize));
+
+			return *this;
 		}
 
 		BigInt &operator--() noexcept
@@ -397,385 +508,466 @@ namespace math
 
 		const BigInt operator--(int) noexcept
 		{
-			return *this -= (int_t)1;
+			BigInt old = *this;
+			*this -= (int_t)1;
+			return old;
 		}
 
 		[[nodiscard]] BigInt operator-(const int_t rhs) const noexcept
 		{
-			return *this - BigInt(rhs);
+			BigInt out = *this;
+			out -= rhs;
+			return out;
 		}
 
 		BigInt &operator-=(const int_t rhs) noexcept
 		{
-			return *this = *this - rhs;
+			const size_t nOwnUsedSize = usedSize();
+			if (m_data.size() == 0)
+				m_data.resize(1);
+
+			borrowCorrect(kernel::sub_1(m_data.data(), m_data.data(), m_data.size(), rhs.u64), nOwnUsedSize);
+			return *this;
+		}
+
+		[[nodiscard]] BigInt operator-(const uint64_t rhs) const noexcept
+		{
+			return *this - int_t(rhs);
+		}
+
+		BigInt &operator-=(const uint64_t rhs) noexcept
+		{
+			return *this -= int_t(rhs);
 		}
 
 	public: // *, *=
 		[[nodiscard]] BigInt operator*(const BigInt &rhs) const noexcept
 		{
-			auto saveMul = [](const uint64_t a, const uint64_t b) -> uint64_t
-			{
-				return a * b;
-			};
+			const size_t nOwnUsedSize = usedSize();
+			const size_t nRhsUsedSize = rhs.usedSize();
 
-			size_t nOwnUsedSize = usedSize();
-			size_t nRhsUsedSize = rhs.usedSize();
+			if (nOwnUsedSize == 0 || nRhsUsedSize == 0)
+				return BigInt(0);
 
 			BigInt out;
-			out.m_data.resize(nOwnUsedSize * nRhsUsedSize + 1);
-
-			for (uint64_t i = 0; i < nOwnUsedSize * 2; i++)
-			{
-				for (uint64_t j = 0; j < nRhsUsedSize * 2; j++)
-				{
-					uint64_t value = saveMul(getBlock(i / 2).u32[i % 2], rhs.getBlock(j / 2).u32[j % 2]);
-					out.addOffset(value, i + j);
-				}
-			}
+			out.m_data.resize(nOwnUsedSize + nRhsUsedSize);
+			mul::multiply(out.m_data.data(), m_data.data(), nOwnUsedSize, rhs.m_data.data(), nRhsUsedSize);
 
 			return out;
 		}
 
-		BigInt operator*=(const BigInt &rhs) noexcept
+		BigInt &operator*=(const BigInt &rhs) noexcept
 		{
+			// a single limb factor is applied in place, everything else needs a separate product buffer
+			if (rhs.usedSize() <= 1)
+				return *this *= rhs.getBlockCheck(0).u64;
+
 			return *this = *this * rhs;
 		}
 
+		[[nodiscard]] BigInt operator*(const uint64_t rhs) const noexcept
+		{
+			const size_t nOwnUsedSize = usedSize();
+			if (nOwnUsedSize == 0 || rhs == 0)
+				return BigInt(0);
+
+			BigInt out;
+			out.m_data.resize(nOwnUsedSize);
+			out.carryCorrect(kernel::mul_1(out.m_data.data(), m_data.data(), nOwnUsedSize, rhs));
+			return out;
+		}
+
+		BigInt &operator*=(const uint64_t rhs) noexcept
+		{
+			const size_t nOwnUsedSize = std::max(usedSize(), (size_t)1);
+			m_data.shrink_to(nOwnUsedSize);
+			m_data.resize(nOwnUsedSize);
+			carryCorrect(kernel::mul_1(m_data.data(), m_data.data(), nOwnUsedSize, rhs));
+			return *this;
+		}
+
 	public:
 		BigInt operator~() const noexcept
 		{
 			BigInt out;
 			out.m_data.resize(m_data.size());
 
-			for (uint64_t i = 0; i < m_data.size(); i++)
-				out.setBlock(i, ~getBlock(i));
+			const int_t *p = m_data.data();
+			int_t *q = out.m_data.data();
+			for (size_t i = 0; i < m_data.size(); i++)
+				q[i] = ~p[i].u64;
 
 			return out;
 		}
 
 		BigInt operator<<(const size_t nBits) const noexcept
 		{
-			BigInt out;
-			out.m_data.resize(std::max(usedSize(), (size_t)1));
+			BigInt out = *this;
+			out <<= nBits;
+			return out;
+		}
+
+		BigInt operator<<(const BigInt nBits) const noexcept
+		{
+			return *this << static_cast<size_t>(nBits.getBlockCheck(0).u64);
+		}
+
+		BigInt &operator<<=(const size_t nBits) noexcept
+		{
+			const size_t nOwnUsedSize = usedSize();
+			if (nOwnUsedSize == 0)
+				return *this;
 
 			const size_t nBlockOffset = nBits / 64;
-			const size_t nBitOffset = nBits % 64;
+			const unsigned nBitOffset = nBits % 64;
+
+			// the storage only grows by the shifted limbs plus one limb for the bits carried out
+			m_data.shrink_to(nOwnUsedSize);
+			m_data.resize(nOwnUsedSize + nBlockOffset);
+			int_t *p = m_data.data();
+
+			uint64_t carry = 0;
+			if (nBitOffset)
+				carry = p[nOwnUsedSize - 1].u64 >> (64 - nBitOffset);
 
-			int_t carry = 0;
-			for (uint64_t i = 0; i < m_data.size(); i++)
+			size_t i = nOwnUsedSize;
+			while (i-- != 0)
 			{
-				int_t thisBlock = getBlock(i);
-				out.setBlock(i + nBlockOffset, thisBlock << nBitOffset | carry);
-				carry = nBitOffset > 0 ? thisBlock >> (64 - nBitOffset) : int_t(0);
+				const uint64_t lower = (nBitOffset && i > 0) ? p[i - 1].u64 >> (64 - nBitOffset) : 0;
+				p[i + nBlockOffset] = (nBitOffset ? p[i].u64 << nBitOffset : p[i].u64) | lower;
 			}
+			std::fill(p, p + nBlockOffset, int_t(0));
 
-			out.carryCorrect(carry.u32[0]);
+			carryCorrect(carry);
+			return *this;
+		}
 
+		BigInt operator>>(const size_t nBits) const noexcept
+		{
+			BigInt out = *this;
+			out >>= nBits;
 			return out;
 		}
 
-		BigInt operator<<(const BigInt nBits) const noexcept
+		BigInt &operator>>=(const size_t nBits) noexcept
 		{
-			const size_t nBlockOffset = (nBits / 64).getBlock(0).u64;
-			const size_t nBitOffset   = nBits.getBlock(0).u64 % 64;
-
-			BigInt out;
-			out.m_data.resize(std::max(usedSize(), (size_t)1));
+			const size_t nOwnUsedSize = usedSize();
+			const size_t nBlockOffset = nBits / 64;
+			const unsigned nBitOffset = nBits % 64;
 
-			int_t carry = 0;
-			for (uint64_t i = 0; i < m_data.size(); i++)
+			if (nBlockOffset >= nOwnUsedSize)
 			{
-				int_t thisBlock = getBlock(i);
-				out.setBlock(i + nBlockOffset, thisBlock << nBitOffset | carry);
-				carry = nBitOffset > 0 ? thisBlock >> (64 - nBitOffset) : int_t(0);
+				m_data.shrink_to(1);
+				m_data.setBlock(0, 0);
+				return *this;
 			}
 
-			out.carryCorrect(carry.u32[0]);
+			const size_t nNewSize = nOwnUsedSize - nBlockOffset;
+			int_t *p = m_data.data();
+			if (nBitOffset)
+				kernel::rshift(p, p + nBlockOffset, nNewSize, nBitOffset);
+			else
+				std::copy(p + nBlockOffset, p + nOwnUsedSize, p);
 
-			return out;
+			m_data.shrink_to(nNewSize);
+			return *this;
 		}
 
-		BigInt operator<<=(const size_t nBits) noexcept
+	public:
+		bool operator<(const BigInt &rhs) const noexcept
 		{
-			*this = *this << nBits;
-			return *this;
+			return compare(rhs) < 0;
 		}
 
-		BigInt operator>>(const size_t nBits) const noexcept
+		bool operator<=(const BigInt &rhs) const noexcept
 		{
-			BigInt out;
-			out.m_data.resize(std::max(usedSize(), (size_t)1));
-
-			const int64_t nBlockOffset = nBits / 64;
-			const uint64_t nBitOffset = nBits % 64;
-
-			int_t carry = 0;
-			for (int64_t i = std::max((int64_t)m_data.size() - 1, nBlockOffset); i >= nBlockOffset; i--)
-			{
-				int_t thisBlock = getBlock(i);
-				out.setBlock(i - nBlockOffset, thisBlock >> nBitOffset | carry);
-				carry = nBitOffset > 0 ? thisBlock << (64 - nBitOffset) : int_t(0);
-			}
+			return compare(rhs) <= 0;
+		}
 
-			return out;
+		bool operator>(const BigInt &rhs) const noexcept
+		{
+			return compare(rhs) > 0;
 		}
 
-		BigInt operator>>=(const size_t nBits) noexcept
+		bool operator>=(const BigInt &rhs) const noexcept
 		{
-			*this = *this >> nBits;
-			return *this;
+			return compare(rhs) >= 0;
+		}
+		
+		bool operator==(const BigInt &rhs) const noexcept
+		{
+			return compare(rhs) == 0;
 		}
 
-	public:
-		bool operator<(const BigInt &rhs) const noexcept
+		bool operator==(const size_t rhs) const noexcept
 		{
 			size_t nOwnUsedSize = usedSize();
-			size_t nRhsUsedSize = rhs.usedSize();
-
-			if (nOwnUsedSize < nRhsUsedSize) return true;
-			if (nOwnUsedSize > nRhsUsedSize) return false;
+			if (nOwnUsedSize > 1) return false;
 
-			uint64_t i = nOwnUsedSize;
-			while (i-- != 0)
-				if (getBlock(i) >= rhs.getBlock(i)) return false;
-			
-			return true;
+			return getBlockCheck(0).u64 == rhs;
 		}
 
-		bool operator<=(const BigInt &rhs) const noexcept
+	private:
+		static void divmod(const BigInt &dividend, const BigInt &divisor, BigInt *pQuotient, BigInt &remainder) BIGINT_NOEXCEPT
 		{
-			size_t nOwnUsedSize = usedSize();
-			size_t nRhsUsedSize = rhs.usedSize();
+			const size_t nDividendSize = dividend.usedSize();
+			const size_t nDivisorSize = divisor.usedSize();
 
-			if (nOwnUsedSize < nRhsUsedSize) return true;
-			if (nOwnUsedSize > nRhsUsedSize) return false;
+#ifdef _BIGINT_EXCEPTIONS_
+			if (nDivisorSize == 0)
+				throw error::division_by_zero{};
+#endif
 
-			uint64_t i = nOwnUsedSize;
-			while (i-- != 0)
+			// without exceptions a division by zero yields the dividend as remainder
+			if (nDivisorSize == 0 || nDividendSize < nDivisorSize)
 			{
-				if (getBlock(i) > rhs.getBlock(i)) return false;
-				if (getBlock(i) < rhs.getBlock(i)) return true;
+				remainder = dividend;
+				if (pQuotient) *pQuotient = BigInt(0);
+				return;
 			}
 
-			return getBlock(0) == rhs.getBlock(0);
-		}
-
-		bool operator>(const BigInt &rhs) const noexcept
-		{
-			size_t nOwnUsedSize = usedSize();
-			size_t nRhsUsedSize = rhs.usedSize();
+			BigInt quotient, rest;
+			if (pQuotient) quotient.m_data.resize(nDividendSize - nDivisorSize + 1);
+			rest.m_data.resize(nDivisorSize);
 
-			if (nOwnUsedSize > nRhsUsedSize) return true;
-			if (nOwnUsedSize < nRhsUsedSize) return false;
+			int_t *pQuotientData = pQuotient ? quotient.m_data.data() : nullptr;
+			if (nDivisorSize == 1)
+				rest.setBlock(0, kernel::divrem_1(pQuotientData, dividend.m_data.data(), nDividendSize, divisor.getBlock(0).u64));
+			else
+				div::divmod(pQuotientData, rest.m_data.data(), dividend.m_data.data(), nDividendSize, divisor.m_data.data(), nDivisorSize);
 
-			uint64_t i = nOwnUsedSize;
-			while (i-- != 0)
-				if (getBlock(i) <= rhs.getBlock(i)) return false;
+			remainder = std::move(rest);
+			if (pQuotient) *pQuotient = std::move(quotient);
+		}
 
-			return true;
+	public:
+		static void divmod(const BigInt &dividend, const BigInt &divisor, BigInt &quotinent, BigInt &remainder) BIGINT_NOEXCEPT
+		{
+			divmod(dividend, divisor, &quotinent, remainder);
 		}
 
-		bool operator>=(const BigInt &rhs) const noexcept
+		BigInt operator/(const BigInt &rhs) const BIGINT_NOEXCEPT
 		{
-			size_t nOwnUsedSize = usedSize();
-			size_t nRhsUsedSize = rhs.usedSize();
+			BigInt quotient, remainder;
+			divmod(*this, rhs, &quotient, remainder);
+			return quotient;
+		}
 
-			if (nOwnUsedSize > nRhsUsedSize) return true;
-			if (nOwnUsedSize < nRhsUsedSize) return false;
+		BigInt &operator/=(const BigInt &rhs) BIGINT_NOEXCEPT
+		{
+			const size_t nOwnUsedSize = usedSize();
+			const size_t nRhsUsedSize = rhs.usedSize();
 
-			uint64_t i = nOwnUsedSize;
-			while (i-- != 0)
+			if (nRhsUsedSize == 0 || nRhsUsedSize > nOwnUsedSize)
 			{
-				if (getBlock(i) < rhs.getBlock(i)) return false;
-				if (getBlock(i) > rhs.getBlock(i)) return true;
+				BigInt remainder;
+				divmod(*this, rhs, this, remainder);
+				return *this;
 			}
 
-			return getBlock(0) == rhs.getBlock(0);
+			// the quotient overwrites the dividend from the top, algorithm D copies its input first
+			int_t *p = m_data.data();
+			if (nRhsUsedSize == 1)
+				kernel::divrem_1(p, p, nOwnUsedSize, rhs.getBlock(0).u64);
+			else
+				div::divmod(p, nullptr, p, nOwnUsedSize, rhs.m_data.data(), nRhsUsedSize);
+
+			m_data.shrink_to(nOwnUsedSize - nRhsUsedSize + 1);
+			return *this;
 		}
-		
-		bool operator==(const BigInt &rhs) const noexcept
+
+		BigInt operator%(const BigInt &rhs) const BIGINT_NOEXCEPT
 		{
-			size_t nOwnUsedSize = usedSize();
-			size_t nRhsUsedSize = rhs.usedSize();
+			BigInt remainder;
+			divmod(*this, rhs, nullptr, remainder);
+			return remainder;
+		}
 
-			if (nOwnUsedSize != nRhsUsedSize) return false;
+		BigInt &operator%=(const BigInt &rhs) BIGINT_NOEXCEPT
+		{
+			const size_t nOwnUsedSize = usedSize();
+			const size_t nRhsUsedSize = rhs.usedSize();
 
-			uint64_t i = nOwnUsedSize;
-			while (i-- != 0)
-				if (getBlock(i) != rhs.getBlock(i)) return false;
+			if (nRhsUsedSize == 0 || nRhsUsedSize > nOwnUsedSize)
+			{
+				BigInt remainder;
+				divmod(*this, rhs, nullptr, remainder);
+				return *this = std::move(remainder);
+			}
 
-			return true;
+			int_t *p = m_data.data();
+			if (nRhsUsedSize == 1)
+				p[0] = kernel::divrem_1(nullptr, p, nOwnUsedSize, rhs.getBlock(0).u64);
+			else
+				div::divmod(nullptr, p, p, nOwnUsedSize, rhs.m_data.data(), nRhsUsedSize);
+
+			m_data.shrink_to(nRhsUsedSize);
+			return *this;
 		}
 
-		bool operator==(const size_t rhs) const noexcept
+	public: // /, %, /=, %= by a single limb
+		// without exceptions a division by zero yields 0 as quotient and as remainder
+		BigInt operator/(const uint64_t rhs) const BIGINT_NOEXCEPT
 		{
-			size_t nOwnUsedSize = usedSize();
-			if (nOwnUsedSize > 1) return false;
-
-			return getBlock(0).u64 == rhs;
+			BigInt out = *this;
+			out /= rhs;
+			return out;
 		}
 
-	public:
-		static void divmod(const BigInt &dividend, const BigInt &divisor, BigInt &quotinent, BigInt &remainder) noexcept
+		BigInt &operator/=(const uint64_t rhs) BIGINT_NOEXCEPT
 		{
-			quotinent = BigInt(0);
-			remainder = BigInt(0);
+			const size_t nOwnUsedSize = usedSize();
+#ifdef _BIGINT_EXCEPTIONS_
+			if (rhs == 0)
+				throw error::division_by_zero{};
+#endif
+			if (rhs == 0 || nOwnUsedSize == 0)
+				return *this = BigInt(0);
 
-			size_t i = dividend.m_data.size();
-			while (i-- != 0)
-			{
-				size_t bit = 64;
-				while (bit-- != 0)
-				{
-					remainder.shift_left_set_last_bit(dividend.getBlock(i).u64 >> bit & 1);
+			kernel::divrem_1(m_data.data(), m_data.data(), nOwnUsedSize, rhs);
+			m_data.shrink_to(nOwnUsedSize);
+			return *this;
+		}
 
-					if (divisor <= remainder)
-					{
-						quotinent.setBit(i, bit);
-						remainder -= divisor;
-					}
-				}
-			}
+		[[nodiscard]] uint64_t operator%(const uint64_t rhs) const BIGINT_NOEXCEPT
+		{
+#ifdef _BIGINT_EXCEPTIONS_
+			if (rhs == 0)
+				throw error::division_by_zero{};
+#endif
+			if (rhs == 0)
+				return 0;
+
+			return kernel::divrem_1(nullptr, m_data.data(), usedSize(), rhs);
 		}
 
-		BigInt operator/(const BigInt &rhs) const noexcept
+		BigInt &operator%=(const uint64_t rhs) BIGINT_NOEXCEPT
 		{
-			BigInt quotient, remainder;
-			divmod(*this, rhs, quotient, remainder);
-			return quotient;
+			const uint64_t nRemainder = *this % rhs;
+			m_data.shrink_to(1);
+			m_data.setBlock(0, nRemainder);
+			return *this;
 		}
 
-		BigInt operator/=(const BigInt &rhs) noexcept
+		BigInt operator/(const SmallDivisor &rhs) const BIGINT_NOEXCEPT
 		{
-			return *this = *this / rhs;
+			BigInt out = *this;
+			out /= rhs;
+			return out;
 		}
 
-		BigInt operator%(const BigInt &rhs) const noexcept
+		BigInt &operator/=(const SmallDivisor &rhs) BIGINT_NOEXCEPT
 		{
-			BigInt remainder = BigInt(0);
+			const size_t nOwnUsedSize = usedSize();
+#ifdef _BIGINT_EXCEPTIONS_
+			if (rhs.divisor() == 0)
+				throw error::division_by_zero{};
+#endif
+			if (rhs.divisor() == 0 || nOwnUsedSize == 0)
+				return *this = BigInt(0);
 
-			size_t i = m_data.size();
-			while (i-- != 0)
-			{
-				size_t bit = 64;
-				while (bit-- != 0)
-				{
-					remainder.shift_left_set_last_bit(getBlock(i).u64 >> bit & 1);
+			rhs.divrem(m_data.data(), m_data.data(), nOwnUsedSize);
+			m_data.shrink_to(nOwnUsedSize);
+			return *this;
+		}
 
-					if (remainder >= rhs)
-						remainder -= rhs;
-				}
-			}
+		[[nodiscard]] uint64_t operator%(const SmallDivisor &rhs) const BIGINT_NOEXCEPT
+		{
+#ifdef _BIGINT_EXCEPTIONS_
+			if (rhs.divisor() == 0)
+				throw error::division_by_zero{};
+#endif
+			if (rhs.divisor() == 0)
+				return 0;
 
-			return remainder;
+			return rhs.divrem(nullptr, m_data.data(), usedSize());
 		}
 
-		BigInt operator%=(const BigInt &rhs) noexcept
+		BigInt &operator%=(const SmallDivisor &rhs) BIGINT_NOEXCEPT
 		{
-			return *this = *this % rhs;
+			const uint64_t nRemainder = *this % rhs;
+			m_data.shrink_to(1);
+			m_data.setBlock(0, nRemainder);
+			return *this;
 		}
 
 	public:
 		BigInt operator&(const BigInt &rhs) const noexcept
 		{
-			size_t nMinUsedSize = getMinUsedSize(rhs);
+			const size_t nMinUsedSize = getMinUsedSize(rhs);
 
 			BigInt out;
 			out.m_data.resize(std::max(nMinUsedSize, (size_t)1));
 
+			const int_t *p = m_data.data(), *q = rhs.m_data.data();
+			int_t *r = out.m_data.data();
 			for (size_t i = 0; i < nMinUsedSize; i++)
-				out.setBlock(i, getBlock(i) & rhs.getBlock(i));
+				r[i] = p[i] & q[i];
 			
 			return out;
 		}
 
-		BigInt operator&=(const BigInt &rhs) noexcept
+		BigInt &operator&=(const BigInt &rhs) noexcept
 		{
-			size_t nMinUsedSize = getMinUsedSize(rhs);
+			const size_t nMinUsedSize = getMinUsedSize(rhs);
 
+			int_t *p = m_data.data();
+			const int_t *q = rhs.m_data.data();
 			for (size_t i = 0; i < nMinUsedSize; i++)
-				setBlock(i, getBlock(i) & rhs.getBlock(i));
+				p[i] &= q[i];
+
+			// everything above the shorter operand is cleared
+			m_data.shrink_to(std::max(nMinUsedSize, (size_t)1));
+			if (nMinUsedSize == 0)
+				m_data.setBlock(0, 0);
 
 			return *this;
 		}
 		
 		BigInt operator|(const BigInt &rhs) const noexcept
 		{
-			size_t nMinUsedSize = getMinUsedSize(rhs);
-
-			BigInt out;
-			out.m_data.resize(std::max(nMinUsedSize, (size_t)1));
-
-			for (size_t i = 0; i < nMinUsedSize; i++)
-				out.setBlock(i, getBlock(i) | rhs.getBlock(i));
-
+			BigInt out = *this;
+			out |= rhs;
 			return out;
 		}
 
-		BigInt operator|=(const BigInt &rhs) noexcept
+		BigInt &operator|=(const BigInt &rhs) noexcept
 		{
-			size_t nMinUsedSize = getMinUsedSize(rhs);
+			const size_t nRhsUsedSize = rhs.usedSize();
+			if (m_data.size() < nRhsUsedSize)
+				m_data.resize(nRhsUsedSize);
 
-			for (size_t i = 0; i < nMinUsedSize; i++)
-				setBlock(i, getBlock(i) | rhs.getBlock(i));
+			int_t *p = m_data.data();
+			const int_t *q = rhs.m_data.data();
+			for (size_t i = 0; i < nRhsUsedSize; i++)
+				p[i] |= q[i];
 
 			return *this;
 		}
 
 		BigInt operator^(const BigInt &rhs) const noexcept
 		{
-			size_t nMinUsedSize = getMinUsedSize(rhs);
-
-			BigInt out;
-			out.m_data.resize(std::max(nMinUsedSize, (size_t)1));
-
-			for (size_t i = 0; i < nMinUsedSize; i++)
-				out.setBlock(i, getBlock(i) ^ rhs.getBlock(i));
-
+			BigInt out = *this;
+			out ^= rhs;
 			return out;
 		}
 
-		BigInt operator^=(const BigInt &rhs) noexcept
+		BigInt &operator^=(const BigInt &rhs) noexcept
 		{
-			size_t nMinUsedSize = getMinUsedSize(rhs);
+			const size_t nRhsUsedSize = rhs.usedSize();
+			if (m_data.size() < nRhsUsedSize)
+				m_data.resize(nRhsUsedSize);
 
-			for (size_t i = 0; i < nMinUsedSize; i++)
-				setBlock(i, getBlock(i) ^ rhs.getBlock(i));
+			int_t *p = m_data.data();
+			const int_t *q = rhs.m_data.data();
+			for (size_t i = 0; i < nRhsUsedSize; i++)
+				p[i] ^= q[i];
 
 			return *this;
 		}
 
 	public:
-		BigInt powmod(const BigInt &exponent, const BigInt &modulus) const noexcept
-		{
-			BigInt out = BigInt(1);
-			out.m_data.resize(2 * usedSize() + 1);
-
-			bool bBitSet = false;
-			size_t i = exponent.usedSize();
-			while (i-- != 0)
-			{
-				size_t bit = 1Ui64 << 63;
-				do
-				{
-					if (bBitSet)
-					{
-						BigInt n = out;
-						out *= n;
-						out %= modulus;
-					}
-					if (exponent.getBlock(i).u64 & bit)
-					{
-						out *= *this;
-						out %= modulus;
-						bBitSet = true;
-					}
-					bit >>= 1;
-				} while (bit != 0);
-			}
-
-			return out;
-		}
+		BigInt powmod(const BigInt &exponent, const BigInt &modulus) const noexcept;
 
 		/*BigInt pow(const BigInt &exponent) const noexcept
 		{
@@ -807,8 +999,10 @@ namespace math
 		}*/
 	};
 
-	bool operator>=(const int_t lhs, const BigInt &rhs) noexcept
+	inline bool operator>=(const int_t lhs, const BigInt &rhs) noexcept
 	{
 		return BigInt(lhs) >= rhs;
 	}
 }
+
+#include "modular.h"
@@ -0,0 +1,323 @@
+#pragma once
+
+#include "BigInt.h"
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace math
+{
+	// sign and magnitude on top of BigInt, zero is never negative. division truncates towards zero
+	// like the built in integers, the remainder takes the sign of the dividend
+	class BigSInt
+	{
+	private:
+		BigInt m_magnitude;
+		bool m_bNegative = false;
+
+	public:
+		BigSInt() noexcept = default;
+
+		BigSInt(const BigInt &magnitude, const bool bNegative = false) noexcept
+			: m_magnitude(magnitude)
+		{
+			m_bNegative = bNegative;
+			normalizeSign();
+		}
+
+		BigSInt(BigInt &&magnitude, const bool bNegative = false) noexcept
+			: m_magnitude(std::move(magnitude))
+		{
+			m_bNegative = bNegative;
+			normalizeSign();
+		}
+
+		BigSInt(const int64_t value) noexcept
+			: m_magnitude(value < 0 ? uint64_t(0) - uint64_t(value) : uint64_t(value))
+		{
+			m_bNegative = value < 0;
+		}
+
+		// an optional minus sign followed by anything BigInt accepts
+		explicit BigSInt(std::string_view svNumber) BIGINT_NOEXCEPT
+		{
+			const bool bNegative = !svNumber.empty() && svNumber.front() == '-';
+			if (bNegative)
+				svNumber.remove_prefix(1);
+
+			m_magnitude = BigInt(svNumber);
+			m_bNegative = bNegative;
+			normalizeSign();
+		}
+
+	private:
+		void normalizeSign() noexcept
+		{
+			m_bNegative = m_bNegative && !(m_magnitude == 0);
+		}
+
+		// *this += (-1)^bNegative magnitude
+		void add(const BigInt &magnitude, const bool bNegative) noexcept
+		{
+			if (m_bNegative == bNegative)
+			{
+				m_magnitude += magnitude;
+				return;
+			}
+
+			if (m_magnitude.compare(magnitude) >= 0)
+				m_magnitude -= magnitude;
+			else
+			{
+				// magnitude - m_magnitude in place, the result takes the sign of the larger operand
+				const size_t nSize = magnitude.usedSize();
+				m_magnitude.m_data.shrink_to(nSize);
+				m_magnitude.m_data.resize(nSize);
+				int_t *p = m_magnitude.m_data.data();
+				kernel::sub_n(p, magnitude.m_data.data(), p, nSize);
+				m_bNegative = bNegative;
+			}
+			normalizeSign();
+		}
+
+	public:
+		[[nodiscard]] const BigInt &magnitude() const noexcept
+		{
+			return m_magnitude;
+		}
+
+		[[nodiscard]] bool isNegative() const noexcept
+		{
+			return m_bNegative;
+		}
+
+		[[nodiscard]] bool isZero() const noexcept
+		{
+			return m_magnitude == 0;
+		}
+
+		// -1, 0 or 1
+		[[nodiscard]] int sign() const noexcept
+		{
+			return m_bNegative ? -1 : !isZero();
+		}
+
+		// negative values wrap around like BigInt's unary minus
+		explicit operator BigInt() const noexcept
+		{
+			return m_bNegative ? -m_magnitude : m_magnitude;
+		}
+
+		// the representative in [0, m)
+		[[nodiscard]] BigInt mod(const BigInt &modulus) const BIGINT_NOEXCEPT
+		{
+			BigInt r = m_magnitude % modulus;
+			if (m_bNegative && !(r == 0))
+				return modulus - r;
+			return r;
+		}
+
+		// -1, 0 or 1 like memcmp
+		[[nodiscard]] int compare(const BigSInt &rhs) const noexcept
+		{
+			if (m_bNegative != rhs.m_bNegative)
+				return m_bNegative ? -1 : 1;
+
+			const int nCompare = m_magnitude.compare(rhs.m_magnitude);
+			return m_bNegative ? -nCompare : nCompare;
+		}
+
+	public:
+		friend std::string to_string(const BigSInt &value, const int nBase = 10) noexcept
+		{
+			return value.m_bNegative ? "-" + to_string(value.m_magnitude, nBase) : to_string(value.m_magnitude, nBase);
+		}
+
+		friend std::ostream &operator<<(std::ostream &os, const BigSInt &i) noexcept
+		{
+			if (i.m_bNegative) os << "-";
+			return os << i.m_magnitude;
+		}
+
+	public: // +; -
+		[[nodiscard]] BigSInt operator+() const noexcept
+		{
+			return *this;
+		}
+
+		[[nodiscard]] BigSInt operator-() const noexcept
+		{
+			BigSInt v = *this;
+			v.m_bNegative = !v.m_bNegative;
+			v.normalizeSign();
+			return v;
+		}
+
+	public: // +; +=; ++; -; -=; --
+		[[nodiscard]] BigSInt operator+(const BigSInt &rhs) const noexcept
+		{
+			BigSInt out = *this;
+			out.add(rhs.m_magnitude, rhs.m_bNegative);
+			return out;
+		}
+
+		BigSInt &operator+=(const BigSInt &rhs) noexcept
+		{
+			add(rhs.m_magnitude, rhs.m_bNegative);
+			return *this;
+		}
+
+		BigSInt &operator++() noexcept
+		{
+			add(BigInt(1), false);
+			return *this;
+		}
+
+		const BigSInt operator++(int) noexcept
+		{
+			BigSInt old = *this;
+			++*this;
+			return old;
+		}
+
+		[[nodiscard]] BigSInt operator-(const BigSInt &rhs) const noexcept
+		{
+			BigSInt out = *this;
+			out.add(rhs.m_magnitude, !rhs.m_bNegative);
+			return out;
+		}
+
+		BigSInt &operator-=(const BigSInt &rhs) noexcept
+		{
+			add(rhs.m_magnitude, !rhs.m_bNegative);
+			return *this;
+		}
+
+		BigSInt &operator--() noexcept
+		{
+			add(BigInt(1), true);
+			return *this;
+		}
+
+		const BigSInt operator--(int) noexcept
+		{
+			BigSInt old = *this;
+			--*this;
+			return old;
+		}
+
+	public: // *, *=
+		[[nodiscard]] BigSInt operator*(const BigSInt &rhs) const noexcept
+		{
+			return BigSInt(m_magnitude * rhs.m_magnitude, m_bNegative != rhs.m_bNegative);
+		}
+
+		BigSInt &operator*=(const BigSInt &rhs) noexcept
+		{
+			m_bNegative = m_bNegative != rhs.m_bNegative;
+			m_magnitude *= rhs.m_magnitude;
+			normalizeSign();
+			return *this;
+		}
+
+	public: // /, %, /=, %=
+		static void divmod(const BigSInt &dividend, const BigSInt &divisor, BigSInt &quotient, BigSInt &remainder) BIGINT_NOEXCEPT
+		{
+			const bool bQuotientNegative = dividend.m_bNegative != divisor.m_bNegative;
+			const bool bRemainderNegative = dividend.m_bNegative;
+			BigInt::divmod(dividend.m_magnitude, divisor.m_magnitude, quotient.m_magnitude, remainder.m_magnitude);
+			quotient.m_bNegative = bQuotientNegative;
+			remainder.m_bNegative = bRemainderNegative;
+			quotient.normalizeSign();
+			remainder.normalizeSign();
+		}
+
+		[[nodiscard]] BigSInt operator/(const BigSInt &rhs) const BIGINT_NOEXCEPT
+		{
+			return BigSInt(m_magnitude / rhs.m_magnitude, m_bNegative != rhs.m_bNegative);
+		}
+
+		BigSInt &operator/=(const BigSInt &rhs) BIGINT_NOEXCEPT
+		{
+			m_bNegative = m_bNegative != rhs.m_bNegative;
+			m_magnitude /= rhs.m_magnitude;
+			normalizeSign();
+			return *this;
+		}
+
+		[[nodiscard]] BigSInt operator%(const BigSInt &rhs) const BIGINT_NOEXCEPT
+		{
+			return BigSInt(m_magnitude % rhs.m_magnitude, m_bNegative);
+		}
+
+		BigSInt &operator%=(const BigSInt &rhs) BIGINT_NOEXCEPT
+		{
+			m_magnitude %= rhs.m_magnitude;
+			normalizeSign();
+			return *this;
+		}
+
+	public: // <<, >>, <<=, >>=
+		[[nodiscard]] BigSInt operator<<(const size_t nBits) const noexcept
+		{
+			return BigSInt(m_magnitude << nBits, m_bNegative);
+		}
+
+		BigSInt &operator<<=(const size_t nBits) noexcept
+		{
+			m_magnitude <<= nBits;
+			return *this;
+		}
+
+		// rounds towards negative infinity like an arithmetic shift
+		[[nodiscard]] BigSInt operator>>(const size_t nBits) const noexcept
+		{
+			BigSInt out = *this;
+			out >>= nBits;
+			return out;
+		}
+
+		BigSInt &operator>>=(const size_t nBits) noexcept
+		{
+			if (!m_bNegative)
+			{
+				m_magnitude >>= nBits;
+				return *this;
+			}
+
+			// -floor(-x / 2^n) = (|x| - 1) / 2^n + 1
+			m_magnitude -= (int_t)1;
+			m_magnitude >>= nBits;
+			m_magnitude += (int_t)1;
+			return *this;
+		}
+
+	public:
+		bool operator<(const BigSInt &rhs) const noexcept
+		{
+			return compare(rhs) < 0;
+		}
+
+		bool operator<=(const BigSInt &rhs) const noexcept
+		{
+			return compare(rhs) <= 0;
+		}
+
+		bool operator>(const BigSInt &rhs) const noexcept
+		{
+			return compare(rhs) > 0;
+		}
+
+		bool operator>=(const BigSInt &rhs) const noexcept
+		{
+			return compare(rhs) >= 0;
+		}
+
+		bool operator==(const BigSInt &rhs) const noexcept
+		{
+			return compare(rhs) == 0;
+		}
+	};
+}
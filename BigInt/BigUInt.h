@@ -0,0 +1,452 @@
+#pragma once
+
+#include "BigInt.h"
+#include <array>
+#include <type_traits>
+
+namespace math
+{
+	// unsigned integer of a fixed width of nBits bits (a multiple of 64) without any heap storage.
+	// arithmetic wraps around modulo 2^nBits like the built in unsigned types, mulWide gives the full
+	// product. every loop runs over the whole width, so each instantiation gets its own unrolled code
+	template <size_t nBits>
+	class BigUInt
+	{
+		static_assert(nBits > 0 && nBits % 64 == 0, "the width has to be a positive multiple of 64 bits");
+
+		template <size_t>
+		friend class BigUInt;
+
+	public:
+		static constexpr size_t nLimbs = nBits / 64;
+
+	private:
+		std::array<int_t, nLimbs> m_data{};
+
+	public:
+		constexpr BigUInt() noexcept = default;
+
+		constexpr BigUInt(const uint64_t value) noexcept
+		{
+			m_data[0] = value;
+		}
+
+		constexpr BigUInt(const int_t value) noexcept
+		{
+			m_data[0] = value;
+		}
+
+		// keeps the low nBits bits
+		explicit BigUInt(const BigInt &value) noexcept
+		{
+			const size_t nSize = std::min(value.getBlockCount(), nLimbs);
+			for (size_t i = 0; i < nSize; i++)
+				m_data[i] = value.getBlock(i);
+		}
+
+		// zero extends or keeps the low nBits bits
+		template <size_t nOtherBits>
+		constexpr explicit BigUInt(const BigUInt<nOtherBits> &value) noexcept
+		{
+			constexpr size_t nSize = std::min(nLimbs, BigUInt<nOtherBits>::nLimbs);
+			std::copy(value.m_data.begin(), value.m_data.begin() + nSize, m_data.begin());
+		}
+
+		[[nodiscard]] BigInt toBigInt() const noexcept
+		{
+			BigInt out = BigInt(0);
+
+			// the top limb first, so that the storage is resized only once
+			size_t i = usedSize();
+			while (i-- != 0)
+				out.setBlock(i, m_data[i]);
+
+			return out;
+		}
+
+	public:
+		[[nodiscard]] constexpr int_t getBlock(const size_t index) const noexcept
+		{
+			return m_data[index];
+		}
+
+		constexpr void setBlock(const size_t index, const int_t block) noexcept
+		{
+			m_data[index] = block;
+		}
+
+		[[nodiscard]] constexpr size_t usedSize() const noexcept
+		{
+			return kernel::normalized_size(m_data.data(), nLimbs);
+		}
+
+		[[nodiscard]] constexpr size_t getBitCount() const noexcept
+		{
+			const size_t nUsedSize = usedSize();
+			if (nUsedSize == 0) return 0;
+
+			return nUsedSize * 64 - std::countl_zero(m_data[nUsedSize - 1].u64);
+		}
+
+		[[nodiscard]] constexpr bool getBit(const size_t nBit) const noexcept
+		{
+			return nBit < nBits && (m_data[nBit / 64].u64 >> (nBit % 64) & 1);
+		}
+
+		friend std::ostream &operator<<(std::ostream &os, const BigUInt &i) noexcept
+		{
+			return os << i.toBigInt();
+		}
+
+	public: // +; +=; ++
+		[[nodiscard]] constexpr BigUInt operator+(const BigUInt &rhs) const noexcept
+		{
+			BigUInt out;
+			kernel::add_n(out.m_data.data(), m_data.data(), rhs.m_data.data(), nLimbs);
+			return out;
+		}
+
+		constexpr BigUInt &operator+=(const BigUInt &rhs) noexcept
+		{
+			kernel::add_n(m_data.data(), m_data.data(), rhs.m_data.data(), nLimbs);
+			return *this;
+		}
+
+		constexpr BigUInt &operator++() noexcept
+		{
+			kernel::add_1(m_data.data(), m_data.data(), nLimbs, 1);
+			return *this;
+		}
+
+		constexpr BigUInt operator++(int) noexcept
+		{
+			const BigUInt old = *this;
+			++*this;
+			return old;
+		}
+
+	public: // -; -=; --
+		[[nodiscard]] constexpr BigUInt operator-(const BigUInt &rhs) const noexcept
+		{
+			BigUInt out;
+			kernel::sub_n(out.m_data.data(), m_data.data(), rhs.m_data.data(), nLimbs);
+			return out;
+		}
+
+		constexpr BigUInt &operator-=(const BigUInt &rhs) noexcept
+		{
+			kernel::sub_n(m_data.data(), m_data.data(), rhs.m_data.data(), nLimbs);
+			return *this;
+		}
+
+		constexpr BigUInt &operator--() noexcept
+		{
+			kernel::sub_1(m_data.data(), m_data.data(), nLimbs, 1);
+			return *this;
+		}
+
+		constexpr BigUInt operator--(int) noexcept
+		{
+			const BigUInt old = *this;
+			--*this;
+			return old;
+		}
+
+	public: // *, *=
+		// the low nBits bits of the product, limbs above the width are never computed
+		[[nodiscard]] constexpr BigUInt operator*(const BigUInt &rhs) const noexcept
+		{
+			BigUInt out;
+			for (size_t i = 0; i < nLimbs; i++)
+				kernel::addmul_1(out.m_data.data() + i, m_data.data(), nLimbs - i, rhs.m_data[i].u64);
+			return out;
+		}
+
+		constexpr BigUInt &operator*=(const BigUInt &rhs) noexcept
+		{
+			return *this = *this * rhs;
+		}
+
+		[[nodiscard]] constexpr BigUInt<2 * nBits> mulWide(const BigUInt &rhs) const noexcept
+		{
+			BigUInt<2 * nBits> out;
+			int_t *r = out.m_data.data();
+
+			if (!std::is_constant_evaluated() && nLimbs >= g_nKaratsubaThreshold)
+			{
+				mul::multiply(r, m_data.data(), nLimbs, rhs.m_data.data(), nLimbs);
+				return out;
+			}
+
+			for (size_t i = 0; i < nLimbs; i++)
+				r[nLimbs + i].u64 = kernel::addmul_1(r + i, m_data.data(), nLimbs, rhs.m_data[i].u64);
+			return out;
+		}
+
+	public: // /; /=; %; %=
+		static constexpr void divmod(const BigUInt &dividend, const BigUInt &divisor, BigUInt &quotient, BigUInt &remainder) BIGINT_NOEXCEPT
+		{
+			const size_t nDividendSize = dividend.usedSize();
+			const size_t nDivisorSize = divisor.usedSize();
+
+#ifdef _BIGINT_EXCEPTIONS_
+			if (nDivisorSize == 0)
+				throw error::division_by_zero{};
+#endif
+
+			// without exceptions a division by zero yields the dividend as remainder, like BigInt
+			if (nDivisorSize == 0 || nDividendSize < nDivisorSize)
+			{
+				remainder = dividend;
+				quotient = BigUInt();
+				return;
+			}
+
+			BigUInt q, r;
+			if (nDivisorSize == 1)
+				r.m_data[0].u64 = kernel::divrem_1(q.m_data.data(), dividend.m_data.data(), nDividendSize, divisor.m_data[0].u64);
+			else
+			{
+				std::array<int_t, 2 * nLimbs + 1> aScratch{};
+				div::divmod(q.m_data.data(), r.m_data.data(), dividend.m_data.data(), nDividendSize, divisor.m_data.data(), nDivisorSize, aScratch.data());
+			}
+
+			quotient = q;
+			remainder = r;
+		}
+
+		[[nodiscard]] constexpr BigUInt operator/(const BigUInt &rhs) const BIGINT_NOEXCEPT
+		{
+			BigUInt quotient, remainder;
+			divmod(*this, rhs, quotient, remainder);
+			return quotient;
+		}
+
+		constexpr BigUInt &operator/=(const BigUInt &rhs) BIGINT_NOEXCEPT
+		{
+			BigUInt remainder;
+			divmod(*this, rhs, *this, remainder);
+			return *this;
+		}
+
+		[[nodiscard]] constexpr BigUInt operator%(const BigUInt &rhs) const BIGINT_NOEXCEPT
+		{
+			BigUInt quotient, remainder;
+			divmod(*this, rhs, quotient, remainder);
+			return remainder;
+		}
+
+		constexpr BigUInt &operator%=(const BigUInt &rhs) BIGINT_NOEXCEPT
+		{
+			BigUInt quotient;
+			divmod(*this, rhs, quotient, *this);
+			return *this;
+		}
+
+	public: // <<; <<=; >>; >>=
+		constexpr BigUInt &operator<<=(const size_t nShift) noexcept
+		{
+			if (nShift >= nBits)
+				return *this = BigUInt();
+
+			const size_t nBlockOffset = nShift / 64;
+			const unsigned nBitOffset = nShift % 64;
+			int_t *d = m_data.data();
+
+			if (nBitOffset)
+				kernel::lshift(d, d, nLimbs - nBlockOffset, nBitOffset);
+			std::copy_backward(d, d + nLimbs - nBlockOffset, d + nLimbs);
+			std::fill(d, d + nBlockOffset, int_t(0));
+			return *this;
+		}
+
+		[[nodiscard]] constexpr BigUInt operator<<(const size_t nShift) const noexcept
+		{
+			BigUInt out = *this;
+			return out <<= nShift;
+		}
+
+		constexpr BigUInt &operator>>=(const size_t nShift) noexcept
+		{
+			if (nShift >= nBits)
+				return *this = BigUInt();
+
+			const size_t nBlockOffset = nShift / 64;
+			const unsigned nBitOffset = nShift % 64;
+			int_t *d = m_data.data();
+
+			std::copy(d + nBlockOffset, d + nLimbs, d);
+			std::fill(d + nLimbs - nBlockOffset, d + nLimbs, int_t(0));
+			if (nBitOffset)
+				kernel::rshift(d, d, nLimbs - nBlockOffset, nBitOffset);
+			return *this;
+		}
+
+		[[nodiscard]] constexpr BigUInt operator>>(const size_t nShift) const noexcept
+		{
+			BigUInt out = *this;
+			return out >>= nShift;
+		}
+
+	public: // comparison
+		[[nodiscard]] constexpr bool operator==(const BigUInt &rhs) const noexcept
+		{
+			return kernel::cmp(m_data.data(), rhs.m_data.data(), nLimbs) == 0;
+		}
+
+		[[nodiscard]] constexpr bool operator!=(const BigUInt &rhs) const noexcept
+		{
+			return kernel::cmp(m_data.data(), rhs.m_data.data(), nLimbs) != 0;
+		}
+
+		[[nodiscard]] constexpr bool operator<(const BigUInt &rhs) const noexcept
+		{
+			return kernel::cmp(m_data.data(), rhs.m_data.data(), nLimbs) < 0;
+		}
+
+		[[nodiscard]] constexpr bool operator<=(const BigUInt &rhs) const noexcept
+		{
+			return kernel::cmp(m_data.data(), rhs.m_data.data(), nLimbs) <= 0;
+		}
+
+		[[nodiscard]] constexpr bool operator>(const BigUInt &rhs) const noexcept
+		{
+			return kernel::cmp(m_data.data(), rhs.m_data.data(), nLimbs) > 0;
+		}
+
+		[[nodiscard]] constexpr bool operator>=(const BigUInt &rhs) const noexcept
+		{
+			return kernel::cmp(m_data.data(), rhs.m_data.data(), nLimbs) >= 0;
+		}
+
+	public: // &; |; ^; ~
+		[[nodiscard]] constexpr BigUInt operator&(const BigUInt &rhs) const noexcept
+		{
+			BigUInt out = *this;
+			return out &= rhs;
+		}
+
+		constexpr BigUInt &operator&=(const BigUInt &rhs) noexcept
+		{
+			for (size_t i = 0; i < nLimbs; i++)
+				m_data[i].u64 &= rhs.m_data[i].u64;
+			return *this;
+		}
+
+		[[nodiscard]] constexpr BigUInt operator|(const BigUInt &rhs) const noexcept
+		{
+			BigUInt out = *this;
+			return out |= rhs;
+		}
+
+		constexpr BigUInt &operator|=(const BigUInt &rhs) noexcept
+		{
+			for (size_t i = 0; i < nLimbs; i++)
+				m_data[i].u64 |= rhs.m_data[i].u64;
+			return *this;
+		}
+
+		[[nodiscard]] constexpr BigUInt operator^(const BigUInt &rhs) const noexcept
+		{
+			BigUInt out = *this;
+			return out ^= rhs;
+		}
+
+		constexpr BigUInt &operator^=(const BigUInt &rhs) noexcept
+		{
+			for (size_t i = 0; i < nLimbs; i++)
+				m_data[i].u64 ^= rhs.m_data[i].u64;
+			return *this;
+		}
+
+		[[nodiscard]] constexpr BigUInt operator~() const noexcept
+		{
+			BigUInt out;
+			for (size_t i = 0; i < nLimbs; i++)
+				out.m_data[i] = ~m_data[i].u64;
+			return out;
+		}
+
+	private:
+		// sliding window over the odd powers of x, multiply(r, a, b) sets r = a b in the chosen domain
+		template <typename Multiply>
+		static constexpr BigUInt slidingWindow(const BigUInt &x, const BigUInt &exponent, const BigUInt &one, Multiply multiply) noexcept
+		{
+			const size_t nWindowBits = window::bitsFor(exponent.getBitCount());
+			const size_t nTableSize = size_t(1) << (nWindowBits - 1);
+
+			std::array<BigUInt, size_t(1) << (window::bitsFor(~size_t(0)) - 1)> aTable{};
+			aTable[0] = x;
+			if (nTableSize > 1)
+			{
+				BigUInt x2;
+				multiply(x2, x, x);
+				for (size_t i = 1; i < nTableSize; i++)
+					multiply(aTable[i], aTable[i - 1], x2);
+			}
+
+			BigUInt acc = one;
+			bool bStarted = false;
+			window::forEach(exponent, nWindowBits, [&](const size_t nSquarings, const size_t nIndex)
+			{
+				if (bStarted)
+					for (size_t i = 0; i < nSquarings; i++)
+						multiply(acc, acc, acc);
+
+				if (nIndex == window::npos)
+					return;
+
+				if (bStarted)
+					multiply(acc, acc, aTable[nIndex]);
+				else
+					acc = aTable[nIndex];
+				bStarted = true;
+			});
+
+			return acc;
+		}
+
+	public:
+		// this^exponent mod modulus. odd moduli use montgomery multiplication with R = 2^nBits,
+		// even ones the full product followed by a division
+		[[nodiscard]] constexpr BigUInt powmod(const BigUInt &exponent, const BigUInt &modulus) const noexcept
+		{
+			if (modulus.getBitCount() < 2)
+				return BigUInt();
+
+			const BigUInt base = *this < modulus ? *this : *this % modulus;
+
+			if ((modulus.m_data[0].u64 & 1) == 0)
+			{
+				const BigUInt<2 * nBits> wideModulus = BigUInt<2 * nBits>(modulus);
+				return slidingWindow(base, exponent, BigUInt(1), [&](BigUInt &r, const BigUInt &a, const BigUInt &b)
+				{
+					r = BigUInt(a.mulWide(b) % wideModulus);
+				});
+			}
+
+			const int_t *n = modulus.m_data.data();
+			const uint64_t n0 = n[0].u64;
+			uint64_t inv = n0;
+			for (int i = 0; i < 5; i++)
+				inv *= 2 - n0 * inv;
+			const uint64_t nInverse = 0 - inv;
+
+			std::array<int_t, nLimbs + 1> aScratch{};
+			const auto redc = [&](BigUInt &r, const BigUInt &a, const BigUInt &b)
+			{
+				kernel::mont_mul(r.m_data.data(), a.m_data.data(), b.m_data.data(), n, nLimbs, nInverse, aScratch.data());
+			};
+
+			// R mod n is 2^nBits - n reduced, R^2 mod n needs the double width
+			const BigUInt one = (BigUInt() - modulus) % modulus;
+			const BigUInt r2 = BigUInt(one.mulWide(one) % BigUInt<2 * nBits>(modulus));
+
+			BigUInt x;
+			redc(x, base, r2);
+			BigUInt out = slidingWindow(x, exponent, one, redc);
+			redc(out, out, BigUInt(1));
+			return out;
+		}
+	};
+}
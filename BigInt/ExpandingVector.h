@@ -1,45 +1,209 @@
 #pragma once
 
-#include <vector>
 #include "int_type.h"
-#include <iostream>
+#include "exceptions.h"
+#include "allocator.h"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+
+// number of limbs stored inside the object before the vector spills to the heap
+#ifndef _BIGINT_INLINE_BLOCKS_
+#define _BIGINT_INLINE_BLOCKS_ 4
+#endif
 
 class ExpandingVector
 {
-	std::vector<math::int_t> m_vData;
-	
+public:
+	static constexpr size_t nInlineBlocks = _BIGINT_INLINE_BLOCKS_;
+	static_assert(nInlineBlocks > 0, "at least one inline block is required");
+
+private:
+	math::int_t *m_pData = m_aInline;
+	std::pmr::memory_resource *m_pResource = math::memory::resource();
+	size_t m_nSize = 0;
+	size_t m_nCapacity = nInlineBlocks;
+	math::int_t m_aInline[nInlineBlocks];
+
 public:
 	ExpandingVector() noexcept = default;
 
+	explicit ExpandingVector(std::pmr::memory_resource *pResource) noexcept
+	{
+		m_pResource = pResource;
+	}
+
+	ExpandingVector(const ExpandingVector &rhs) noexcept
+	{
+		assign(rhs);
+	}
+
+	// the moved to vector adopts the resource of rhs
+	ExpandingVector(ExpandingVector &&rhs) noexcept
+	{
+		m_pResource = rhs.m_pResource;
+		take(rhs);
+	}
+
+	~ExpandingVector() noexcept
+	{
+		release();
+	}
+
+	ExpandingVector &operator=(const ExpandingVector &rhs) noexcept
+	{
+		if (this != &rhs)
+			assign(rhs);
+		return *this;
+	}
+
+	ExpandingVector &operator=(ExpandingVector &&rhs) noexcept
+	{
+		if (this == &rhs)
+			return *this;
+
+		// memory of another resource can't be adopted, it has to be copied
+		if (m_pResource == rhs.m_pResource || *m_pResource == *rhs.m_pResource)
+		{
+			release();
+			take(rhs);
+		}
+		else
+			assign(rhs);
+		return *this;
+	}
+
+private:
+	bool isInline() const noexcept
+	{
+		return m_pData == m_aInline;
+	}
+
+	void release() noexcept
+	{
+		if (!isInline())
+			m_pResource->deallocate(m_pData, m_nCapacity * sizeof(math::int_t), alignof(math::int_t));
+
+		m_pData = m_aInline;
+		m_nCapacity = nInlineBlocks;
+	}
+
+	void assign(const ExpandingVector &rhs) noexcept
+	{
+		m_nSize = 0;
+		reserve(rhs.m_nSize);
+		std::copy(rhs.m_pData, rhs.m_pData + rhs.m_nSize, m_pData);
+		m_nSize = rhs.m_nSize;
+	}
+
+	// steals the heap block of rhs or copies its inline limbs, rhs is left empty
+	void take(ExpandingVector &rhs) noexcept
+	{
+		if (rhs.isInline())
+		{
+			std::copy(rhs.m_aInline, rhs.m_aInline + rhs.m_nSize, m_aInline);
+			m_pData = m_aInline;
+			m_nCapacity = nInlineBlocks;
+		}
+		else
+		{
+			m_pData = rhs.m_pData;
+			m_nCapacity = rhs.m_nCapacity;
+			rhs.m_pData = rhs.m_aInline;
+			rhs.m_nCapacity = nInlineBlocks;
+		}
+
+		m_nSize = rhs.m_nSize;
+		rhs.m_nSize = 0;
+	}
+
 public:
+#ifdef _BIGINT_MEMCHECK_
+	math::int_t getBlock(const size_t index) const
+	{
+		if (index >= m_nSize)
+			throw math::error::out_of_bounds{};
+		return m_pData[index];
+	}
+#else
 	math::int_t getBlock(const size_t index) const noexcept
 	{
-		return m_vData.at(index);
+		return m_pData[index];
 	}
+#endif
 
 	void setBlock(const size_t index, const math::int_t data) noexcept
 	{
-		if (index >= m_vData.size())
-		{
+		if (index >= m_nSize)
 			resize(index + 1);
-			//std::cout << "reallocation" << std::endl;
-		}
-		m_vData.at(index) = data;
+		m_pData[index] = data;
+	}
+
+	void reserve(const size_t capacity) noexcept
+	{
+		if (capacity <= m_nCapacity)
+			return;
+
+		// powers of two fit the size classes of the pool
+		const size_t nNewCapacity = std::max(std::bit_ceil(capacity), 2 * m_nCapacity);
+		math::int_t *pNewData = static_cast<math::int_t *>(m_pResource->allocate(nNewCapacity * sizeof(math::int_t), alignof(math::int_t)));
+		std::copy(m_pData, m_pData + m_nSize, pNewData);
+
+		release();
+		m_pData = pNewData;
+		m_nCapacity = nNewCapacity;
 	}
 
+	// new blocks are zero
 	void resize(const size_t size) noexcept
 	{
-		m_vData.resize(size);
+		if (size > m_nSize)
+		{
+			reserve(size);
+			std::fill(m_pData + m_nSize, m_pData + size, math::int_t(0));
+		}
+		m_nSize = size;
+	}
+
+	math::int_t *data() noexcept
+	{
+		return m_pData;
+	}
+
+	const math::int_t *data() const noexcept
+	{
+		return m_pData;
 	}
 
 	size_t size() const noexcept
 	{
-		return m_vData.size();
+		return m_nSize;
+	}
+
+	size_t capacity() const noexcept
+	{
+		return m_nCapacity;
+	}
+
+	std::pmr::memory_resource *resource() const noexcept
+	{
+		return m_pResource;
+	}
+
+	// takes over pData[0, capacity) holding size blocks, which has to come from pResource->allocate
+	// with capacity * sizeof(int_t) bytes and the alignment of int_t
+	void adopt(math::int_t *pData, const size_t size, const size_t capacity, std::pmr::memory_resource *pResource) noexcept
+	{
+		release();
+		m_pData = pData;
+		m_pResource = pResource;
+		m_nSize = size;
+		m_nCapacity = capacity;
 	}
 
 	void shrink_to(const size_t size) noexcept
 	{
-		while (this->size() > size)
-			m_vData.pop_back();
+		if (size < m_nSize)
+			m_nSize = size;
 	}
 };
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// bounded multi producer multi consumer queue after dmitry vyukov. every cell carries a sequence
+// number that tells producers and consumers whether it is theirs to fill or to empty
+template <typename T>
+class LockFreeQueue
+{
+private:
+	struct Cell
+	{
+		std::atomic<size_t> nSequence;
+		T value;
+	};
+
+	std::unique_ptr<Cell[]> m_pCells;
+	size_t m_nMask = 0;
+	alignas(64) std::atomic<size_t> m_nEnqueue = 0;
+	alignas(64) std::atomic<size_t> m_nDequeue = 0;
+
+public:
+	// the capacity is rounded up to a power of two
+	explicit LockFreeQueue(const size_t nCapacity)
+	{
+		const size_t nCells = std::bit_ceil(std::max<size_t>(nCapacity, 2));
+		m_pCells = std::make_unique<Cell[]>(nCells);
+		m_nMask = nCells - 1;
+		for (size_t i = 0; i < nCells; i++)
+			m_pCells[i].nSequence.store(i, std::memory_order_relaxed);
+	}
+
+	LockFreeQueue(const LockFreeQueue &) = delete;
+	LockFreeQueue &operator=(const LockFreeQueue &) = delete;
+
+public:
+	// false if the queue is full, value is left untouched then
+	bool tryPush(T &value) noexcept
+	{
+		size_t nPosition = m_nEnqueue.load(std::memory_order_relaxed);
+		while (true)
+		{
+			Cell &cell = m_pCells[nPosition & m_nMask];
+			const size_t nSequence = cell.nSequence.load(std::memory_order_acquire);
+			const ptrdiff_t nDiff = ptrdiff_t(nSequence) - ptrdiff_t(nPosition);
+
+			if (nDiff == 0)
+			{
+				if (m_nEnqueue.compare_exchange_weak(nPosition, nPosition + 1, std::memory_order_relaxed))
+				{
+					cell.value = std::move(value);
+					cell.nSequence.store(nPosition + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (nDiff < 0)
+				return false;
+			else
+				nPosition = m_nEnqueue.load(std::memory_order_relaxed);
+		}
+	}
+
+	// false if the queue is empty
+	bool tryPop(T &value) noexcept
+	{
+		size_t nPosition = m_nDequeue.load(std::memory_order_relaxed);
+		while (true)
+		{
+			Cell &cell = m_pCells[nPosition & m_nMask];
+			const size_t nSequence = cell.nSequence.load(std::memory_order_acquire);
+			const ptrdiff_t nDiff = ptrdiff_t(nSequence) - ptrdiff_t(nPosition + 1);
+
+			if (nDiff == 0)
+			{
+				if (m_nDequeue.compare_exchange_weak(nPosition, nPosition + 1, std::memory_order_relaxed))
+				{
+					value = std::move(cell.value);
+					cell.nSequence.store(nPosition + m_nMask + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (nDiff < 0)
+				return false;
+			else
+				nPosition = m_nDequeue.load(std::memory_order_relaxed);
+		}
+	}
+};
@@ -1,48 +1,66 @@
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <iomanip>
 #include <cstring>
 #include <fstream>
+#include <stdexcept>
 
 #include "Timer.h"
 #include "BigInt.h"
 #include "Random.h"
 #include "Prime.h"
+#include "PrimeStore.h"
+#include "PrimeSearch.h"
 #include "euclidean.h"
+#include "RSA.h"
 
 int main_find_primes()
 {
-	std::ofstream file = std::ofstream("large_primes.txt");
-	if (!file.is_open()) return EXIT_FAILURE;
+	PrimeStoreWriter store = PrimeStoreWriter("large_primes.bin");
+	if (!store.isOpen()) return EXIT_FAILURE;
 
-	Random randomDevice = Random(0);
-
-	math::BigInt n;
+	PrimeSearch search = PrimeSearch(1024, std::thread::hardware_concurrency(), 4);
 	while (true)
 	{
-		n = randomDevice.get(1024);
-		if (primeTest_MillerRabin(n, randomDevice, 4))
-		{
-			std::cout << n << std::endl;
-			file << n << '\n';
-			file.flush();
-		}
+		for (const math::BigInt &prime : search.run(16, PrimeSearch::clock::time_point::max(), &store))
+			std::cout << prime << '\n';
+
+		const PrimeSearchStats stats = search.stats();
+		std::cout << stats.candidatesPerSecond() << " candidates/s, " << stats.primesPerSecond() << " primes/s, " << stats.sieveRejectionRate() * 100 << "% sieved out" << std::endl;
 	}
 
 	return EXIT_FAILURE;
 }
 
-math::BigInt readNumber(const size_t index)
+// converts the text list of primes into a prime store
+bool importPrimes(const std::string &sTextPath, const std::string &sStorePath)
 {
-	std::ifstream file = std::ifstream("large_primes.txt");
-	if (!file.is_open()) throw std::runtime_error("primes file not found");
+	std::ifstream file = std::ifstream(sTextPath);
+	if (!file.is_open()) return false;
 
-	size_t i = 0;
+	PrimeStoreWriter store = PrimeStoreWriter(sStorePath);
 	std::string sLine;
-	while (std::getline(file, sLine) && i++ != index);
-	file.close();
+	while (std::getline(file, sLine))
+		if (!sLine.empty())
+			store.append(math::BigInt(sLine));
 
-	return math::BigInt(sLine);
+	return store.isOpen();
+}
+
+math::BigInt readNumber(const size_t index)
+{
+	static const PrimeStore store = []()
+	{
+		PrimeStore primes = PrimeStore("large_primes.bin");
+		if (!primes.isOpen() && importPrimes("large_primes.txt", "large_primes.bin"))
+			primes.open("large_primes.bin");
+		return primes;
+	}();
+
+	if (!store.isOpen()) throw std::runtime_error("prime store not found");
+	if (index >= store.size()) throw std::out_of_range("prime index " + std::to_string(index) + " out of range, the store holds " + std::to_string(store.size()));
+	return store[index];
 }
 
 
@@ -56,6 +74,11 @@ int main_rsa()
 	math::BigInt p = readNumber(10);
 	math::BigInt q = readNumber(25);
 
+	// the store comes from disk, the primes are confirmed before they become a key
+	ThreadPool pool;
+	if (!primeTest_MillerRabinParallel(p, random, pool) || !primeTest_MillerRabinParallel(q, random, pool))
+		return EXIT_FAILURE;
+
 	std::cout << p << std::endl << q << std::endl;
 
 	math::BigInt N = p * q;
@@ -70,16 +93,18 @@ int main_rsa()
 	while (eucl::ggT(euler, e) != 1);
 	std::cout << e << std::endl;
 
-	math::BigInt d = eucl::ext_euclidean(e, euler);
+	const std::optional<RSAPrivateKey> key = RSAPrivateKey::fromPrimes(p, q, e);
+	if (!key) return EXIT_FAILURE;
+	const math::BigInt &d = key->privateExponent();
 
 	std::cout << "d: " << d << std::endl;
 
-	auto test = [N, e](const math::BigInt &d) -> void
+	auto test = [&key](const math::BigInt &d) -> void
 	{
 		std::cout << "\nStarting test with " << d << std::endl;
 		const math::BigInt &msg = 10;
-		math::BigInt c = msg.powmod(e, N);
-		math::BigInt m = c.powmod(d, N);
+		math::BigInt c = key->publicKey().encrypt(msg);
+		math::BigInt m = key->decrypt(c);
 		if (m == msg)
 			std::cout << "Test succeeded.\n";
 		else
@@ -93,3 +118,43 @@ int main_rsa()
 
 	return 0;
 }
+
+// powmod against square and multiply with %, on moduli that are powers of the limb base
+int main_powmod()
+{
+	const math::BigInt base = 3;
+	const math::BigInt exponent = math::BigInt("0x123456789abcdef0123456789");
+
+	bool bSucceeded = true;
+	for (const size_t nBits : { 64, 128 })
+	{
+		const math::BigInt modulus = math::BigInt(1) << nBits;
+		math::BigInt expected = 1, power = base;
+		for (size_t i = 0; i < exponent.getBitCount(); i++)
+		{
+			if (exponent.getBit(i))
+				expected = expected * power % modulus;
+			power = power * power % modulus;
+		}
+
+		bSucceeded &= base.powmod(exponent, modulus) == expected;
+	}
+
+	std::cout << (bSucceeded ? "Test succeeded.\n" : "Test failed.\n");
+	return bSucceeded ? 0 : EXIT_FAILURE;
+}
+
+// consecutive runs of one search continue its random sequence and find different primes
+int main_prime_search()
+{
+	PrimeSearch search = PrimeSearch(256, 2, 4, 1);
+	const std::vector<math::BigInt> vFirst = search.run(16);
+	const std::vector<math::BigInt> vSecond = search.run(16);
+
+	bool bSucceeded = vFirst.size() == 16 && vSecond.size() == 16;
+	for (const math::BigInt &prime : vSecond)
+		bSucceeded &= std::find(vFirst.begin(), vFirst.end(), prime) == vFirst.end();
+
+	std::cout << (bSucceeded ? "Test succeeded.\n" : "Test failed.\n");
+	return bSucceeded ? 0 : EXIT_FAILURE;
+}
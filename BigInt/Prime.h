@@ -1,7 +1,11 @@
 #pragma once
 
 #include "Random.h"
+#include "ThreadPool.h"
 #include <array>
+#include <atomic>
+#include <future>
+#include <vector>
 
 std::array<uint32_t, 70> g_vSomePrimes =
 {   2,   3,   5,   7,  11,  13,  17,  19,  23,  29,
@@ -12,14 +16,49 @@ std::array<uint32_t, 70> g_vSomePrimes =
   233, 239, 241, 251, 257, 263, 269, 271, 277, 281,
   283, 293, 307, 311, 313, 317, 331, 337, 347, 349 };
 
+// runs of g_vSomePrimes whose product fits a limb, nEnd is the index after the run
+struct PrimeProduct
+{
+	math::SmallDivisor divisor;
+	size_t nEnd = 0;
+};
+
+static const std::vector<PrimeProduct> &somePrimeProducts() noexcept
+{
+	static const std::vector<PrimeProduct> vProducts = []()
+	{
+		std::vector<PrimeProduct> result;
+		uint64_t nProduct = 1;
+		for (size_t i = 0; i < g_vSomePrimes.size(); i++)
+		{
+			if (nProduct > UINT64_MAX / g_vSomePrimes[i])
+			{
+				result.push_back(PrimeProduct{ math::SmallDivisor(nProduct), i });
+				nProduct = 1;
+			}
+			nProduct *= g_vSomePrimes[i];
+		}
+		result.push_back(PrimeProduct{ math::SmallDivisor(nProduct), g_vSomePrimes.size() });
+		return result;
+	}();
+
+	return vProducts;
+}
+
 static bool isLowLevelPrime(const math::BigInt &value) noexcept
 {
 	if (value < 2) return false;
 
+	// one pass over the limbs per product, the primes of a run are tested on its remainder
 	if (value > 349 * 349)
 	{
-		for (const uint32_t prime : g_vSomePrimes)
-			if (value % prime == 0) return false;
+		size_t i = 0;
+		for (const PrimeProduct &product : somePrimeProducts())
+		{
+			const uint64_t nResidue = value % product.divisor;
+			for (; i < product.nEnd; i++)
+				if (nResidue % g_vSomePrimes[i] == 0) return false;
+		}
 
 		return true;
 	}
@@ -33,47 +72,112 @@ static bool isLowLevelPrime(const math::BigInt &value) noexcept
 	return true;
 }
 
-static bool millerTest(math::BigInt d, const math::BigInt &n, Random &randomDevice) noexcept
+// all arithmetic happens in the montgomery domain of n
+static bool millerTest(math::BigInt d, const math::MontgomeryContext &context, Random &randomDevice) noexcept
 {
+	const math::BigInt &n = context.modulus();
 	math::BigInt a = randomDevice.range(2, n - (math::int_t)2);
-	math::BigInt x = a.powmod(d, n);
+	math::BigInt x = context.pow(context.toMontgomery(a), d);
 	math::BigInt n_minus_1 = n - (math::int_t)1;
 
-	if (x == 1 || x == n_minus_1) return true;
+	const math::BigInt &one = context.one();
+	const math::BigInt minus_one = n - one;
+
+	if (x == one || x == minus_one) return true;
 
 	while (d != n_minus_1)
 	{
-		math::BigInt k = x * x;
-		x = k % n;
+		x = context.square(x);
 		d <<= 1;
 
-		if (x == 1)
+		if (x == one)
 			return false;
-		if (x == n_minus_1)
+		if (x == minus_one)
 			return true;
 	}
 
 	return false;
 }
 
-static bool primeTest_MillerRabin(const math::BigInt &number, Random &randomDevice, const size_t nIterations = 20) noexcept
+// only the witness rounds, for odd numbers above 349^2 that already passed trial division or a sieve
+static bool primeTest_MillerRabinRounds(const math::BigInt &number, Random &randomDevice, const size_t nIterations = 20) noexcept
 {
-	if (!isLowLevelPrime(number)) return false;
+	// nothing allocated here outlives the call: limbs come from the thread's pool and every round
+	// drops its temporaries at once
+	const math::memory::ScopedResource poolScope = math::memory::ScopedResource(&math::memory::pool());
+	const math::MontgomeryContext context = math::MontgomeryContext(number);
 
 	math::BigInt d = number - (math::int_t)1;
 	while ((d.getBlock(0).u64 & 1) == 0) d >>= 1;
 
 	for (size_t i = 0; i < nIterations; i++)
-		if (!millerTest(d, number, randomDevice))
+	{
+		const math::memory::Arena arena;
+		if (!millerTest(d, context, randomDevice))
 			return false;
+	}
 
 	return true;
 }
 
+static bool primeTest_MillerRabin(const math::BigInt &number, Random &randomDevice, const size_t nIterations = 20) noexcept
+{
+	if (!isLowLevelPrime(number)) return false;
+	// the trial division is exact below 349^2, which also keeps 2 away from the odd-only context
+	if (number < 349 * 349) return true;
+
+	return primeTest_MillerRabinRounds(number, randomDevice, nIterations);
+}
+
+// the rounds of primeTest_MillerRabin spread over the pool and the calling thread. every task draws its
+// witnesses from its own Random seeded by randomDevice, the first witness of compositeness cancels all
+// rounds that haven't started yet. must not be called from a task of the same pool
+static bool primeTest_MillerRabinParallel(const math::BigInt &number, Random &randomDevice, ThreadPool &pool, const size_t nIterations = 20) noexcept
+{
+	if (!isLowLevelPrime(number)) return false;
+	if (number < 349 * 349) return true;
+
+	const math::memory::ScopedResource poolScope = math::memory::ScopedResource(&math::memory::pool());
+	const math::MontgomeryContext context = math::MontgomeryContext(number);
+
+	math::BigInt d = number - (math::int_t)1;
+	while ((d.getBlock(0).u64 & 1) == 0) d >>= 1;
+
+	std::atomic<size_t> nNextRound = 0;
+	std::atomic<bool> bComposite = false;
+	const auto rounds = [&](const uint32_t nSeed)
+	{
+		const math::memory::ScopedResource workerScope = math::memory::ScopedResource(&math::memory::pool());
+		Random random = Random(nSeed);
+
+		while (!bComposite.load(std::memory_order_relaxed) && nNextRound.fetch_add(1, std::memory_order_relaxed) < nIterations)
+		{
+			const math::memory::Arena arena;
+			if (!millerTest(d, context, random))
+				bComposite.store(true, std::memory_order_relaxed);
+		}
+	};
+
+	std::vector<std::future<void>> vTasks;
+	const size_t nTasks = std::min(pool.size(), nIterations > 0 ? nIterations - 1 : 0);
+	for (size_t i = 0; i < nTasks; i++)
+		vTasks.push_back(pool.submit([&rounds, nSeed = randomDevice.get32()]() { rounds(nSeed); }));
+
+	rounds(randomDevice.get32());
+	for (std::future<void> &task : vTasks)
+		task.wait();
+
+	return !bComposite.load();
+}
+
 static bool isPrime_Fermat(const math::BigInt &p, Random &random)
 {
 	if (!isLowLevelPrime(p)) return false;
 
+	if (p < 349 * 349) return true;
+
+	const math::MontgomeryContext context = math::MontgomeryContext(p);
+	const math::BarrettContext reducer = math::BarrettContext(p);
 	math::BigInt pminus1 = p - (math::int_t)1;
 	size_t nBitCount = Random::getBitCount(p);
 
@@ -83,10 +187,10 @@ static bool isPrime_Fermat(const math::BigInt &p, Random &random)
 
 		math::BigInt x;
 		do
-			x = random.get(2 * nBitCount) % p;
+			x = reducer.reduce(random.get(2 * nBitCount));
 		while (x == 0);
 		
-		if (x.powmod(pminus1, p) != 1)
+		if (context.powmod(x, pminus1) != 1)
 		{
 			std::cout << std::endl;
 			return false;
@@ -0,0 +1,257 @@
+#pragma once
+
+#include "Prime.h"
+#include "Sieve.h"
+#include "PrimeStore.h"
+#include "LockFreeQueue.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct PrimeSearchStats
+{
+	uint64_t nCandidates = 0;
+	uint64_t nTested = 0; // candidates that survived the sieve
+	uint64_t nPrimes = 0;
+	double dSeconds = 0.0;
+
+public:
+	[[nodiscard]] double candidatesPerSecond() const noexcept
+	{
+		return dSeconds > 0.0 ? nCandidates / dSeconds : 0.0;
+	}
+
+	[[nodiscard]] double primesPerSecond() const noexcept
+	{
+		return dSeconds > 0.0 ? nPrimes / dSeconds : 0.0;
+	}
+
+	[[nodiscard]] double sieveRejectionRate() const noexcept
+	{
+		return nCandidates > 0 ? 1.0 - double(nTested) / nCandidates : 0.0;
+	}
+};
+
+// searches random primes of a fixed bit size on worker threads. a worker that runs dry opens a window of
+// consecutive odd candidates at a random start, sieves it and queues it in batches, idle workers steal
+// batches from the others. only survivors of the sieve see miller rabin, primes go through a lock free
+// queue to the thread that called run
+class PrimeSearch
+{
+public:
+	using clock = std::chrono::steady_clock;
+
+	static constexpr size_t nWindowCandidates = 4096;
+	static constexpr size_t nBatchCandidates  = 64;
+
+private:
+	// candidates start + 2 k for k in [0, m_nWindowCandidates)
+	struct Window
+	{
+		math::BigInt start;
+		CandidateSieve sieve;
+	};
+
+	struct Batch
+	{
+		std::shared_ptr<const Window> pWindow;
+		size_t nBegin = 0;
+		size_t nEnd = 0;
+	};
+
+	// the owner takes batches from the back, thieves from the front
+	struct alignas(64) WorkQueue
+	{
+		std::mutex mutex;
+		std::deque<Batch> qBatches;
+	};
+
+	size_t m_nBits = 0;
+	size_t m_nWindowCandidates = 0; // nWindowCandidates or all odd numbers of m_nBits bits if fewer
+	size_t m_nThreads = 0;
+	size_t m_nRounds = 0;
+	std::vector<Random> m_vRandoms; // one per worker, carried over from run to run
+
+	std::vector<std::unique_ptr<WorkQueue>> m_vQueues;
+	LockFreeQueue<math::BigInt> m_output = LockFreeQueue<math::BigInt>(1024);
+	std::atomic<bool> m_bStop = false;
+	std::atomic<uint64_t> m_nCandidates = 0;
+	std::atomic<uint64_t> m_nTested = 0;
+	std::atomic<uint64_t> m_nPrimes = 0;
+	clock::time_point m_tpStart{};
+	std::atomic<int64_t> m_nRunNanos = 0; // length of the last run, -1 while it is running
+
+public:
+	explicit PrimeSearch(const size_t nBits, const size_t nThreads = std::max(std::thread::hardware_concurrency(), 1u), const size_t nRounds = 20, const uint32_t nSeed = 0)
+	{
+		m_nBits = std::max<size_t>(nBits, 2);
+		m_nWindowCandidates = m_nBits - 2 < 12 ? std::min<size_t>(nWindowCandidates, size_t(1) << (m_nBits - 2)) : nWindowCandidates;
+		m_nThreads = std::max<size_t>(nThreads, 1);
+		m_nRounds = nRounds;
+		for (size_t i = 0; i < m_nThreads; i++)
+			m_vRandoms.push_back(Random(nSeed + uint32_t(i) * 0x9e3779b9u));
+	}
+
+	PrimeSearch(const PrimeSearch &) = delete;
+	PrimeSearch &operator=(const PrimeSearch &) = delete;
+
+private:
+	bool popOwn(const size_t nWorker, Batch &batch)
+	{
+		WorkQueue &queue = *m_vQueues[nWorker];
+		const std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(queue.mutex);
+		if (queue.qBatches.empty())
+			return false;
+
+		batch = std::move(queue.qBatches.back());
+		queue.qBatches.pop_back();
+		return true;
+	}
+
+	bool steal(const size_t nWorker, Batch &batch)
+	{
+		for (size_t i = 1; i < m_vQueues.size(); i++)
+		{
+			WorkQueue &queue = *m_vQueues[(nWorker + i) % m_vQueues.size()];
+			const std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(queue.mutex);
+			if (queue.qBatches.empty())
+				continue;
+
+			batch = std::move(queue.qBatches.front());
+			queue.qBatches.pop_front();
+			return true;
+		}
+
+		return false;
+	}
+
+	// a random odd start 2^(nBits - 1) + 1 + 2 j, low enough that the whole window keeps nBits bits
+	void openWindow(const size_t nWorker, Random &random)
+	{
+		const math::BigInt nLastStart = (math::BigInt(1) << (m_nBits - 2)) - m_nWindowCandidates;
+
+		auto pWindow = std::make_shared<Window>();
+		pWindow->start = (math::BigInt(1) << (m_nBits - 1)) + (random.rangeto(nLastStart) << 1) + 1;
+		pWindow->sieve = CandidateSieve(pWindow->start, m_nWindowCandidates);
+
+		WorkQueue &queue = *m_vQueues[nWorker];
+		const std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(queue.mutex);
+		for (size_t nBegin = m_nWindowCandidates; nBegin != 0;)
+		{
+			const size_t nBatch = std::min(nBegin, nBatchCandidates);
+			queue.qBatches.push_back(Batch{ pWindow, nBegin - nBatch, nBegin });
+			nBegin -= nBatch;
+		}
+	}
+
+	// the worker's generator is taken over for the run and handed back, so the next run continues its sequence
+	void work(const size_t nWorker)
+	{
+		Random random = m_vRandoms[nWorker];
+
+		while (!m_bStop.load(std::memory_order_relaxed))
+		{
+			Batch batch;
+			if (!popOwn(nWorker, batch) && !steal(nWorker, batch))
+			{
+				openWindow(nWorker, random);
+				continue;
+			}
+
+			const Window &window = *batch.pWindow;
+			for (size_t k = batch.nBegin; k < batch.nEnd && !m_bStop.load(std::memory_order_relaxed); k++)
+			{
+				m_nCandidates.fetch_add(1, std::memory_order_relaxed);
+				if (!window.sieve.isSurvivor(k))
+					continue;
+
+				// survivors of an active sieve have no small factors left and are far above 349^2
+				math::BigInt candidate = window.start + math::int_t(2 * k);
+				m_nTested.fetch_add(1, std::memory_order_relaxed);
+				const bool bPrime = window.sieve.isActive()
+					? primeTest_MillerRabinRounds(candidate, random, m_nRounds)
+					: primeTest_MillerRabin(candidate, random, m_nRounds);
+				if (!bPrime)
+					continue;
+
+				m_nPrimes.fetch_add(1, std::memory_order_relaxed);
+				while (!m_output.tryPush(candidate) && !m_bStop.load(std::memory_order_relaxed))
+					std::this_thread::yield();
+			}
+		}
+
+		m_vRandoms[nWorker] = random;
+	}
+
+public:
+	// finds nTarget primes unless the deadline passes first. with a writer every prime is appended and
+	// the store is flushed once per nWriteBatch primes
+	std::vector<math::BigInt> run(const size_t nTarget, const clock::time_point tpDeadline = clock::time_point::max(), PrimeStoreWriter *pWriter = nullptr, const size_t nWriteBatch = 16)
+	{
+		m_vQueues.clear();
+		for (size_t i = 0; i < m_nThreads; i++)
+			m_vQueues.push_back(std::make_unique<WorkQueue>());
+		m_bStop = false;
+		m_nCandidates = 0;
+		m_nTested = 0;
+		m_nPrimes = 0;
+		m_tpStart = clock::now();
+		m_nRunNanos = -1;
+
+		std::vector<std::thread> vWorkers;
+		for (size_t i = 0; i < m_nThreads; i++)
+			vWorkers.emplace_back([this, i]() { work(i); });
+
+		std::vector<math::BigInt> vPrimes;
+		size_t nUnflushed = 0;
+		while (vPrimes.size() < nTarget && clock::now() < tpDeadline)
+		{
+			math::BigInt prime;
+			if (!m_output.tryPop(prime))
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				continue;
+			}
+
+			if (pWriter)
+			{
+				pWriter->append(prime);
+				if (++nUnflushed == nWriteBatch)
+				{
+					pWriter->flush();
+					nUnflushed = 0;
+				}
+			}
+			vPrimes.push_back(std::move(prime));
+		}
+
+		m_bStop = true;
+		for (std::thread &worker : vWorkers)
+			worker.join();
+
+		// primes beyond the target are dropped
+		math::BigInt surplus;
+		while (m_output.tryPop(surplus));
+
+		if (pWriter)
+			pWriter->flush();
+		m_nRunNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - m_tpStart).count();
+		return vPrimes;
+	}
+
+	// counters of the last run, may be read while it is running
+	[[nodiscard]] PrimeSearchStats stats() const noexcept
+	{
+		PrimeSearchStats stats;
+		stats.nCandidates = m_nCandidates.load(std::memory_order_relaxed);
+		stats.nTested = m_nTested.load(std::memory_order_relaxed);
+		stats.nPrimes = m_nPrimes.load(std::memory_order_relaxed);
+		const int64_t nRunNanos = m_nRunNanos.load();
+		stats.dSeconds = nRunNanos < 0 ? std::chrono::duration<double>(clock::now() - m_tpStart).count() : nRunNanos / 1e9;
+		return stats;
+	}
+};
@@ -0,0 +1,308 @@
+#pragma once
+
+#include "BigInt.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// binary store of numbers for random access. the data file holds the little endian limbs of all
+// numbers back to back, the index file "<path>.idx" the limb offset of every number plus the end
+// of the last one. both start with a magic limb, offsets count the limbs after it
+namespace storage
+{
+	constexpr uint64_t nDataMagic  = 0x315441444d495250ULL; // "PRIMDAT1"
+	constexpr uint64_t nIndexMagic = 0x315844494d495250ULL; // "PRIMIDX1"
+
+	inline std::string indexPath(const std::string &sPath)
+	{
+		return sPath + ".idx";
+	}
+
+	// read only mapping of a whole file
+	class MappedFile
+	{
+	private:
+		const uint64_t *m_pData = nullptr;
+		size_t m_nBytes = 0;
+#if defined(_WIN32)
+		HANDLE m_hFile = INVALID_HANDLE_VALUE;
+		HANDLE m_hMapping = nullptr;
+#endif
+
+	public:
+		MappedFile() noexcept = default;
+
+		explicit MappedFile(const std::string &sPath) noexcept
+		{
+#if defined(_WIN32)
+			m_hFile = CreateFileA(sPath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			LARGE_INTEGER size{};
+			if (m_hFile == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_hFile, &size) || size.QuadPart == 0)
+				return;
+
+			m_hMapping = CreateFileMappingA(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (!m_hMapping)
+				return;
+
+			m_pData = static_cast<const uint64_t *>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+			m_nBytes = m_pData ? size_t(size.QuadPart) : 0;
+#else
+			const int fd = ::open(sPath.c_str(), O_RDONLY);
+			if (fd < 0)
+				return;
+
+			struct stat info{};
+			if (fstat(fd, &info) == 0 && info.st_size > 0)
+			{
+				void *p = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+				if (p != MAP_FAILED)
+				{
+					m_pData = static_cast<const uint64_t *>(p);
+					m_nBytes = size_t(info.st_size);
+				}
+			}
+			::close(fd);
+#endif
+		}
+
+		~MappedFile() noexcept
+		{
+			unmap();
+		}
+
+		MappedFile(const MappedFile &) = delete;
+		MappedFile &operator=(const MappedFile &) = delete;
+
+		MappedFile(MappedFile &&rhs) noexcept
+		{
+			*this = std::move(rhs);
+		}
+
+		MappedFile &operator=(MappedFile &&rhs) noexcept
+		{
+			if (this == &rhs)
+				return *this;
+
+			unmap();
+			std::swap(m_pData, rhs.m_pData);
+			std::swap(m_nBytes, rhs.m_nBytes);
+#if defined(_WIN32)
+			std::swap(m_hFile, rhs.m_hFile);
+			std::swap(m_hMapping, rhs.m_hMapping);
+#endif
+			return *this;
+		}
+
+	private:
+		void unmap() noexcept
+		{
+#if defined(_WIN32)
+			if (m_pData)
+				UnmapViewOfFile(m_pData);
+			if (m_hMapping)
+				CloseHandle(m_hMapping);
+			if (m_hFile != INVALID_HANDLE_VALUE)
+				CloseHandle(m_hFile);
+			m_hMapping = nullptr;
+			m_hFile = INVALID_HANDLE_VALUE;
+#else
+			if (m_pData)
+				munmap(const_cast<uint64_t *>(m_pData), m_nBytes);
+#endif
+			m_pData = nullptr;
+			m_nBytes = 0;
+		}
+
+	public:
+		[[nodiscard]] std::span<const uint64_t> limbs() const noexcept
+		{
+			return { m_pData, m_nBytes / sizeof(uint64_t) };
+		}
+	};
+}
+
+// memory mapped read access to a prime store, every lookup is two index reads
+class PrimeStore
+{
+private:
+	storage::MappedFile m_data;
+	storage::MappedFile m_index;
+	std::span<const uint64_t> m_vLimbs;
+	std::span<const uint64_t> m_vOffsets;
+
+public:
+	PrimeStore() noexcept = default;
+
+	explicit PrimeStore(const std::string &sPath) noexcept
+	{
+		open(sPath);
+	}
+
+public:
+	// maps the store, numbers appended later become visible after the next open
+	bool open(const std::string &sPath) noexcept
+	{
+		m_data = storage::MappedFile(sPath);
+		m_index = storage::MappedFile(storage::indexPath(sPath));
+
+		const std::span<const uint64_t> data = m_data.limbs();
+		const std::span<const uint64_t> index = m_index.limbs();
+		if (data.empty() || index.size() < 2 || data[0] != storage::nDataMagic || index[0] != storage::nIndexMagic || index[1] != 0)
+		{
+			m_vLimbs = {};
+			m_vOffsets = {};
+			return false;
+		}
+
+		// the index ends at the first offset that goes backwards or past the data, which is where a
+		// torn write stopped. the numbers before it are complete
+		size_t nOffsets = 1;
+		while (nOffsets + 1 < index.size() && index[nOffsets + 1] >= index[nOffsets] && index[nOffsets + 1] <= data.size() - 1)
+			nOffsets++;
+
+		m_vLimbs = data.subspan(1);
+		m_vOffsets = index.subspan(1, nOffsets);
+		return true;
+	}
+
+	[[nodiscard]] bool isOpen() const noexcept
+	{
+		return !m_vOffsets.empty();
+	}
+
+	[[nodiscard]] size_t size() const noexcept
+	{
+		return m_vOffsets.empty() ? 0 : m_vOffsets.size() - 1;
+	}
+
+	// limbs of all numbers together
+	[[nodiscard]] uint64_t limbCount() const noexcept
+	{
+		return m_vOffsets.empty() ? 0 : m_vOffsets.back();
+	}
+
+	// the limbs of number i inside the mapping, valid as long as the store is open
+	[[nodiscard]] std::span<const uint64_t> limbs(const size_t i) const noexcept
+	{
+		return m_vLimbs.subspan(m_vOffsets[i], m_vOffsets[i + 1] - m_vOffsets[i]);
+	}
+
+	// a copy of number i. BigInt always owns its limbs, so there is no zero copy BigInt: code that only
+	// reads a number should work on limbs(i), which points into the mapping
+	[[nodiscard]] math::BigInt operator[](const size_t i) const noexcept
+	{
+		return math::BigInt::fromLimbs(limbs(i));
+	}
+};
+
+// appends numbers to a prime store, creating it if needed. the limbs are written before their index
+// entry, so a store that is cut off by a crash stays readable up to the last complete number
+class PrimeStoreWriter
+{
+private:
+	std::ofstream m_data;
+	std::ofstream m_index;
+	uint64_t m_nEnd = 0; // limb offset after the last number
+
+public:
+	PrimeStoreWriter() noexcept = default;
+
+	explicit PrimeStoreWriter(const std::string &sPath)
+	{
+		open(sPath);
+	}
+
+	~PrimeStoreWriter()
+	{
+		flush();
+	}
+
+public:
+	// a new store is only created if neither file exists, anything that isn't a readable store is
+	// left untouched and fails
+	bool open(const std::string &sPath)
+	{
+		size_t nCount = 0;
+		bool bValid = false;
+		{
+			const PrimeStore existing = PrimeStore(sPath);
+			bValid = existing.isOpen();
+			nCount = existing.size();
+			m_nEnd = existing.limbCount();
+		}
+
+		const std::ios::openmode mode = std::ios::binary | std::ios::in | std::ios::out;
+		if (!bValid)
+		{
+			std::error_code error;
+			if (std::filesystem::exists(sPath, error) || std::filesystem::exists(storage::indexPath(sPath), error) || error)
+				return false;
+			if (!createEmpty(sPath))
+				return false;
+		}
+		else
+		{
+			// whatever follows the last complete number is cut off, so that stale index entries can't
+			// come back to life once new limbs fill the data file up to where they point
+			std::error_code error;
+			std::filesystem::resize_file(sPath, sizeof(uint64_t) * (1 + m_nEnd), error);
+			if (!error)
+				std::filesystem::resize_file(storage::indexPath(sPath), sizeof(uint64_t) * (2 + nCount), error);
+			if (error)
+				return false;
+		}
+
+		m_data.open(sPath, mode);
+		m_index.open(storage::indexPath(sPath), mode);
+		m_data.seekp(std::streamoff(sizeof(uint64_t) * (1 + m_nEnd)));
+		m_index.seekp(std::streamoff(sizeof(uint64_t) * (2 + nCount)));
+		return isOpen();
+	}
+
+	[[nodiscard]] bool isOpen() const noexcept
+	{
+		return m_data.is_open() && m_index.is_open() && m_data.good() && m_index.good();
+	}
+
+	void append(const math::BigInt &value)
+	{
+		const std::span<const uint64_t> limbs = value.limbs();
+		m_data.write(reinterpret_cast<const char *>(limbs.data()), std::streamsize(limbs.size_bytes()));
+
+		m_nEnd += limbs.size();
+		m_index.write(reinterpret_cast<const char *>(&m_nEnd), sizeof(m_nEnd));
+	}
+
+	void flush()
+	{
+		m_data.flush();
+		m_index.flush();
+	}
+
+private:
+	bool createEmpty(const std::string &sPath)
+	{
+		std::ofstream data = std::ofstream(sPath, std::ios::binary | std::ios::trunc);
+		std::ofstream index = std::ofstream(storage::indexPath(sPath), std::ios::binary | std::ios::trunc);
+		const uint64_t aIndex[2] = { storage::nIndexMagic, 0 };
+		data.write(reinterpret_cast<const char *>(&storage::nDataMagic), sizeof(storage::nDataMagic));
+		index.write(reinterpret_cast<const char *>(aIndex), sizeof(aIndex));
+		m_nEnd = 0;
+		return data.good() && index.good();
+	}
+};
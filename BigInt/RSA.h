@@ -0,0 +1,112 @@
+#pragma once
+
+#include "BigInt.h"
+#include <future>
+#include <optional>
+#include <system_error>
+#include <utility>
+
+struct RSAPublicKey
+{
+	math::BigInt n;
+	math::BigInt e;
+
+public:
+	[[nodiscard]] math::BigInt encrypt(const math::BigInt &message) const noexcept
+	{
+		return message.powmod(e, n);
+	}
+
+	[[nodiscard]] math::BigInt verify(const math::BigInt &signature) const noexcept
+	{
+		return signature.powmod(e, n);
+	}
+};
+
+// private key in the chinese remainder form. the private operation raises to dp mod p and to dq mod q,
+// two exponentiations of half the size with half as long exponents, and puts the halves back together
+// with garner's formula m = m2 + q (qInv (m1 - m2) mod p)
+class RSAPrivateKey
+{
+private:
+	math::BigInt m_n, m_e, m_d;
+	math::BigInt m_p, m_q;
+	math::BigInt m_dp, m_dq; // d mod (p - 1), d mod (q - 1)
+	math::BigInt m_qInv;     // q^-1 mod p
+	math::MontgomeryContext m_contextP, m_contextQ;
+
+public:
+	RSAPrivateKey() noexcept = default;
+
+	// nothing if e isn't invertible modulo (p - 1) (q - 1). p and q have to be distinct odd primes
+	static std::optional<RSAPrivateKey> fromPrimes(const math::BigInt &p, const math::BigInt &q, const math::BigInt &e) noexcept
+	{
+		const math::BigInt pMinusOne = p - (math::int_t)1;
+		const math::BigInt qMinusOne = q - (math::int_t)1;
+		std::optional<math::BigInt> d = modinv(e, pMinusOne * qMinusOne);
+		std::optional<math::BigInt> qInv = modinv(q, p);
+		if (!d || !qInv)
+			return std::nullopt;
+
+		RSAPrivateKey key;
+		key.m_n = p * q;
+		key.m_e = e;
+		key.m_d = std::move(*d);
+		key.m_p = p;
+		key.m_q = q;
+		key.m_dp = key.m_d % pMinusOne;
+		key.m_dq = key.m_d % qMinusOne;
+		key.m_qInv = std::move(*qInv);
+		key.m_contextP = math::MontgomeryContext(p);
+		key.m_contextQ = math::MontgomeryContext(q);
+		return key;
+	}
+
+public:
+	[[nodiscard]] RSAPublicKey publicKey() const noexcept
+	{
+		return RSAPublicKey{ m_n, m_e };
+	}
+
+	[[nodiscard]] const math::BigInt &modulus() const noexcept
+	{
+		return m_n;
+	}
+
+	[[nodiscard]] const math::BigInt &privateExponent() const noexcept
+	{
+		return m_d;
+	}
+
+	// c^d mod n. with bConcurrent the half mod q runs on a second thread, its result is handed back
+	// through a future so that nothing of the calling thread's memory resource is touched there.
+	// if no thread can be started both halves run here
+	[[nodiscard]] math::BigInt decrypt(const math::BigInt &ciphertext, const bool bConcurrent = true) const noexcept
+	{
+		std::future<math::BigInt> futureM2;
+		if (bConcurrent)
+		{
+			try
+			{
+				futureM2 = std::async(std::launch::async, [&]() { return m_contextQ.powmod(ciphertext, m_dq); });
+			}
+			catch (const std::system_error &)
+			{
+			}
+		}
+
+		const math::BigInt m1 = m_contextP.powmod(ciphertext, m_dp);
+		const math::BigInt m2 = futureM2.valid() ? futureM2.get() : m_contextQ.powmod(ciphertext, m_dq);
+
+		// h = qInv (m1 - m2) mod p, m2 < q may exceed p
+		const math::BigInt m2p = m2 % m_p;
+		const math::BigInt difference = m1 < m2p ? m1 + m_p - m2p : m1 - m2p;
+		const math::BigInt h = (m_qInv * difference) % m_p;
+		return m2 + h * m_q;
+	}
+
+	[[nodiscard]] math::BigInt sign(const math::BigInt &message, const bool bConcurrent = true) const noexcept
+	{
+		return decrypt(message, bConcurrent);
+	}
+};
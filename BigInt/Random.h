@@ -1,7 +1,6 @@
 #pragma once
 
 #include "BigInt.h"
-#include <random>
 
 class Random
 {
@@ -67,42 +66,17 @@ public:
 
 	static size_t getBitCount(const math::BigInt &number) noexcept
 	{
-		auto getBit64Count = [](uint64_t n) -> size_t
-		{
-			size_t bits = 0;
-			while (n)
-			{
-				bits++;
-				n >>= 1;
-			}
-
-			return bits;
-		};
-
-		size_t i = number.getBlockCount();
-		while (i-- != 0)
-			if (number.getBlock(i))
-				return i * 64 + getBit64Count(number.getBlock(i).u64);
-
-		return 0;
+		return number.getBitCount();
 	}
 
+	// uniform in [0, upper], drawn from the seeded sequence. numbers of the width of upper are drawn
+	// until one is in range, which takes less than two tries on average
 	math::BigInt rangeto(const math::BigInt &upper) noexcept
 	{
-		math::BigInt random;
-		std::random_device rd;
-		std::default_random_engine generator(rd());
-
-		bool bMaxAllowed = false;
-		size_t i = upper.getBlockCount();
-		while (i-- != 0)
-		{
-			uint64_t nLimit = bMaxAllowed ? 0xFFFFFFFFFFFFFFFF : upper.getBlock(i).u64;
-			std::uniform_int_distribution<uint64_t> dist(0, nLimit);
-			random.setBlock(i, dist(generator));
-			if (!bMaxAllowed && random.getBlock(i) < upper.getBlock(i)) bMaxAllowed = true;
-		}
-
+		const size_t nBits = upper.getBitCount();
+		math::BigInt random = get(nBits);
+		while (random > upper)
+			random = get(nBits);
 		return random;
 	}
 
@@ -0,0 +1,253 @@
+#pragma once
+
+#include "BigInt.h"
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// odd primes up to the limit take out about 90.5% of the odd candidates
+constexpr uint32_t g_nSieveLimit = 1 << 17;
+
+// the remainder tree is followed down to nodes of at most this many limbs, below that every group
+// modulus is reduced from the remainder of its node with one pass of divrem_1
+inline size_t g_nSieveTreeLimbs = 8;
+
+namespace sieve
+{
+	// the primes are grouped so that the product of every group fits a limb, a residue modulo the
+	// product gives the residues modulo all primes of the group
+	struct Group
+	{
+		uint64_t nModulus = 1;
+		math::SmallDivisor divisor;
+		size_t nBegin = 0;
+		size_t nEnd = 0;
+	};
+
+	// one level of the product tree, node i is vLimbs[vOffsets[i], vOffsets[i + 1]) normalized
+	struct Level
+	{
+		std::vector<math::int_t> vLimbs;
+		std::vector<size_t> vOffsets;
+		size_t nMaxSize = 0;
+
+		[[nodiscard]] size_t size() const noexcept
+		{
+			return vOffsets.size() - 1;
+		}
+	};
+
+	// vTree[0] holds the group moduli, every level above the products of pairs of the one below (an odd
+	// node out is carried up alone), the last level is the product of all primes. about 300 KiB
+	struct Tables
+	{
+		std::vector<uint32_t> vPrimes;
+		std::vector<Group> vGroups;
+		std::vector<Level> vTree;
+	};
+
+	inline Level parentLevel(const Level &level) noexcept
+	{
+		Level parent;
+		parent.vOffsets.push_back(0);
+		for (size_t i = 0; i < level.size(); i += 2)
+		{
+			const math::int_t *a = level.vLimbs.data() + level.vOffsets[i];
+			const size_t na = level.vOffsets[i + 1] - level.vOffsets[i];
+			const size_t nOffset = parent.vLimbs.size();
+			if (i + 1 == level.size())
+				parent.vLimbs.insert(parent.vLimbs.end(), a, a + na);
+			else
+			{
+				const math::int_t *b = level.vLimbs.data() + level.vOffsets[i + 1];
+				const size_t nb = level.vOffsets[i + 2] - level.vOffsets[i + 1];
+				parent.vLimbs.resize(nOffset + na + nb);
+				math::mul::multiply(parent.vLimbs.data() + nOffset, a, na, b, nb);
+				parent.vLimbs.resize(nOffset + math::kernel::normalized_size(parent.vLimbs.data() + nOffset, na + nb));
+			}
+
+			parent.vOffsets.push_back(parent.vLimbs.size());
+			parent.nMaxSize = std::max(parent.nMaxSize, parent.vLimbs.size() - nOffset);
+		}
+		return parent;
+	}
+
+	// r[0, nd) = a[0, na) mod d[0, nd) for a normalized d, scratch holds na + nd + 1 limbs
+	inline void reduce(math::int_t *r, const math::int_t *a, size_t na, const math::int_t *d, const size_t nd, math::int_t *scratch) noexcept
+	{
+		na = math::kernel::normalized_size(a, na);
+		if (na < nd || (na == nd && math::kernel::cmp(a, d, nd) < 0))
+		{
+			std::copy(a, a + na, r);
+			std::fill(r + na, r + nd, math::int_t(0));
+		}
+		else if (nd == 1)
+			r[0].u64 = math::kernel::divrem_1(nullptr, a, na, d[0].u64);
+		else
+			math::div::divmod(nullptr, r, a, na, d, nd, scratch);
+	}
+
+	inline const Tables &tables() noexcept
+	{
+		static const Tables tables = []()
+		{
+			// the tables live as long as the program, whatever resource the first caller has in scope
+			const math::memory::ScopedResource scope = math::memory::ScopedResource(std::pmr::new_delete_resource());
+			Tables result;
+			std::vector<bool> vComposite = std::vector<bool>(g_nSieveLimit, false);
+			for (uint32_t i = 3; i < g_nSieveLimit; i += 2)
+			{
+				if (vComposite[i])
+					continue;
+
+				result.vPrimes.push_back(i);
+				for (uint64_t j = uint64_t(i) * i; j < g_nSieveLimit; j += 2 * i)
+					vComposite[j] = true;
+			}
+
+			Group group;
+			for (size_t i = 0; i < result.vPrimes.size(); i++)
+			{
+				if (group.nModulus > UINT64_MAX / result.vPrimes[i])
+				{
+					group.divisor = math::SmallDivisor(group.nModulus);
+					result.vGroups.push_back(group);
+					group = Group{ 1, {}, i, i };
+				}
+
+				group.nModulus *= result.vPrimes[i];
+				group.nEnd = i + 1;
+			}
+			group.divisor = math::SmallDivisor(group.nModulus);
+			result.vGroups.push_back(group);
+
+			Level leaves;
+			leaves.vOffsets.push_back(0);
+			leaves.nMaxSize = 1;
+			for (const Group &g : result.vGroups)
+			{
+				leaves.vLimbs.push_back(math::int_t(g.nModulus));
+				leaves.vOffsets.push_back(leaves.vLimbs.size());
+			}
+
+			result.vTree.push_back(std::move(leaves));
+			while (result.vTree.back().size() > 1)
+				result.vTree.push_back(parentLevel(result.vTree.back()));
+			return result;
+		}();
+
+		return tables;
+	}
+}
+
+// marks which of the odd candidates start + 2 k, k in [0, nCandidates), have a factor below
+// g_nSieveLimit. start is reduced once modulo the products of the tree level whose nodes are about its
+// size, the remainders are taken down the tree to short nodes and from there to the group moduli, and
+// the window is crossed off like the sieve of eratosthenes. starts below the limit aren't sieved, every
+// candidate survives then
+class CandidateSieve
+{
+private:
+	size_t m_nCandidates = 0;
+	bool m_bActive = false;
+	std::vector<uint64_t> m_vComposite;
+
+public:
+	CandidateSieve() noexcept = default;
+
+	CandidateSieve(const math::BigInt &start, const size_t nCandidates) noexcept
+	{
+		m_nCandidates = nCandidates;
+		m_vComposite = std::vector<uint64_t>((nCandidates + 63) / 64, 0);
+		m_bActive = (start.getBlock(0).u64 & 1) != 0 && start >= g_nSieveLimit;
+		if (!m_bActive)
+			return;
+
+		const sieve::Tables &tables = sieve::tables();
+		const std::span<const uint64_t> limbs = start.limbs();
+		const math::int_t *a = reinterpret_cast<const math::int_t *>(limbs.data());
+		const size_t n = limbs.size();
+
+		// the highest level whose nodes are at most as long as start, above it start is its own remainder.
+		// the descent stops at the highest level with nodes of at most g_nSieveTreeLimbs
+		size_t nLevel = tables.vTree.size() - 1;
+		while (nLevel > 0 && tables.vTree[nLevel].nMaxSize > n)
+			nLevel--;
+		size_t nStop = 0;
+		while (nStop + 1 < tables.vTree.size() && tables.vTree[nStop + 1].nMaxSize <= g_nSieveTreeLimbs)
+			nStop++;
+
+		// the remainders of a level are laid out like its nodes. short starts go to the groups directly
+		const bool bTree = n > g_nSieveTreeLimbs && nLevel > nStop;
+		math::memory::vector<math::int_t> vScratch(math::memory::resource());
+		math::memory::vector<math::int_t> vRemainders(math::memory::resource());
+		math::memory::vector<math::int_t> vNext(math::memory::resource());
+		if (bTree)
+		{
+			const sieve::Level &top = tables.vTree[nLevel];
+			vScratch.resize(2 * n + 1);
+			vRemainders.resize(top.vLimbs.size());
+			for (size_t i = 0; i < top.size(); i++)
+				sieve::reduce(vRemainders.data() + top.vOffsets[i], a, n, top.vLimbs.data() + top.vOffsets[i], top.vOffsets[i + 1] - top.vOffsets[i], vScratch.data());
+		}
+
+		for (; bTree && nLevel > nStop; nLevel--)
+		{
+			const sieve::Level &parent = tables.vTree[nLevel];
+			const sieve::Level &level = tables.vTree[nLevel - 1];
+			vNext.resize(level.vLimbs.size());
+			for (size_t i = 0; i < level.size(); i++)
+			{
+				const size_t nParentOffset = parent.vOffsets[i / 2];
+				sieve::reduce(vNext.data() + level.vOffsets[i], vRemainders.data() + nParentOffset, parent.vOffsets[i / 2 + 1] - nParentOffset,
+					level.vLimbs.data() + level.vOffsets[i], level.vOffsets[i + 1] - level.vOffsets[i], vScratch.data());
+			}
+			std::swap(vRemainders, vNext);
+		}
+
+		const sieve::Level &stop = tables.vTree[nStop];
+		for (size_t g = 0; g < tables.vGroups.size(); g++)
+		{
+			// the node above group g on the stop level is g >> nStop
+			const sieve::Group &group = tables.vGroups[g];
+			const size_t nNode = g >> nStop;
+			const uint64_t nResidue = bTree
+				? group.divisor.divrem(nullptr, vRemainders.data() + stop.vOffsets[nNode], stop.vOffsets[nNode + 1] - stop.vOffsets[nNode])
+				: group.divisor.divrem(nullptr, a, n);
+			for (size_t i = group.nBegin; i < group.nEnd; i++)
+			{
+				// start + 2 k = 0 mod p for k = -start / 2 mod p
+				const uint64_t p = tables.vPrimes[i];
+				const uint64_t r = nResidue % p;
+				for (uint64_t k = (p - r) % p * ((p + 1) / 2) % p; k < nCandidates; k += p)
+					m_vComposite[k / 64] |= uint64_t(1) << (k % 64);
+			}
+		}
+	}
+
+public:
+	// false if the sieve had nothing to do, survivors are not known to be free of small factors then
+	[[nodiscard]] bool isActive() const noexcept
+	{
+		return m_bActive;
+	}
+
+	[[nodiscard]] size_t size() const noexcept
+	{
+		return m_nCandidates;
+	}
+
+	[[nodiscard]] bool isSurvivor(const size_t k) const noexcept
+	{
+		return (m_vComposite[k / 64] >> (k % 64) & 1) == 0;
+	}
+
+	[[nodiscard]] size_t survivors() const noexcept
+	{
+		size_t nSurvivors = 0;
+		for (size_t k = 0; k < m_nCandidates; k++)
+			nSurvivors += isSurvivor(k);
+		return nSurvivors;
+	}
+};
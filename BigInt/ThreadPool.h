@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// fixed number of worker threads taking tasks from one shared queue. tasks that are still queued
+// when the pool is destroyed are run before the workers exit
+class ThreadPool
+{
+private:
+	std::vector<std::thread> m_vThreads;
+	std::deque<std::function<void()>> m_qTasks;
+	std::mutex m_mutex;
+	std::condition_variable m_cvTask;
+	bool m_bStopping = false;
+
+public:
+	explicit ThreadPool(const size_t nThreads = std::max(std::thread::hardware_concurrency(), 1u))
+	{
+		m_vThreads.reserve(nThreads);
+		for (size_t i = 0; i < nThreads; i++)
+			m_vThreads.emplace_back([this]() { work(); });
+	}
+
+	~ThreadPool()
+	{
+		{
+			const std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(m_mutex);
+			m_bStopping = true;
+		}
+
+		m_cvTask.notify_all();
+		for (std::thread &thread : m_vThreads)
+			thread.join();
+	}
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+private:
+	void work()
+	{
+		while (true)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(m_mutex);
+				m_cvTask.wait(lock, [this]() { return m_bStopping || !m_qTasks.empty(); });
+				if (m_qTasks.empty())
+					return;
+
+				task = std::move(m_qTasks.front());
+				m_qTasks.pop_front();
+			}
+
+			task();
+		}
+	}
+
+public:
+	[[nodiscard]] size_t size() const noexcept
+	{
+		return m_vThreads.size();
+	}
+
+	// queues the callable, its result or exception is delivered through the future
+	template <typename Function>
+	std::future<std::invoke_result_t<Function>> submit(Function &&function)
+	{
+		using result_t = std::invoke_result_t<Function>;
+
+		// std::function needs a copyable target, the packaged task is shared instead
+		auto pTask = std::make_shared<std::packaged_task<result_t()>>(std::forward<Function>(function));
+		std::future<result_t> result = pTask->get_future();
+		{
+			const std::lock_guard<std::mutex> lock = std::lock_guard<std::mutex>(m_mutex);
+			m_qTasks.emplace_back([pTask]() { (*pTask)(); });
+		}
+
+		m_cvTask.notify_one();
+		return result;
+	}
+};
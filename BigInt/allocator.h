@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+namespace math
+{
+	// limb storage and scratch buffers are taken from the calling thread's current memory resource.
+	// a vector keeps the resource it was constructed with, so values that have to outlive a scoped
+	// resource must be assigned to objects created outside of that scope
+	namespace memory
+	{
+		template <typename T>
+		using vector = std::pmr::vector<T>;
+
+		inline std::pmr::memory_resource *&current() noexcept
+		{
+			thread_local std::pmr::memory_resource *pResource = std::pmr::new_delete_resource();
+			return pResource;
+		}
+
+		[[nodiscard]] inline std::pmr::memory_resource *resource() noexcept
+		{
+			return current();
+		}
+
+		// makes pResource the current resource of this thread until the end of the scope
+		class ScopedResource
+		{
+		private:
+			std::pmr::memory_resource *m_pPrevious = nullptr;
+
+		public:
+			explicit ScopedResource(std::pmr::memory_resource *pResource) noexcept
+			{
+				m_pPrevious = current();
+				current() = pResource;
+			}
+
+			~ScopedResource() noexcept
+			{
+				current() = m_pPrevious;
+			}
+
+			ScopedResource(const ScopedResource &) = delete;
+			ScopedResource &operator=(const ScopedResource &) = delete;
+		};
+
+		// single threaded pool with power of two size classes. freed blocks go to a free list of their
+		// class and are reused, the slabs are only returned upstream when the pool is destroyed
+		class PoolResource : public std::pmr::memory_resource
+		{
+		public:
+			static constexpr size_t nMinBlockBits = 5;
+			static constexpr size_t nMaxBlockBits = 16;
+			static constexpr size_t nSlabBytes = size_t(1) << 16;
+
+		private:
+			struct Node
+			{
+				Node *pNext;
+			};
+
+			struct alignas(std::max_align_t) Slab
+			{
+				Slab *pNext;
+				size_t nBytes;
+			};
+
+			std::pmr::memory_resource *m_pUpstream = nullptr;
+			Node *m_aFree[nMaxBlockBits - nMinBlockBits + 1]{};
+			Slab *m_pSlabs = nullptr;
+
+		public:
+			explicit PoolResource(std::pmr::memory_resource *pUpstream = std::pmr::new_delete_resource()) noexcept
+			{
+				m_pUpstream = pUpstream;
+			}
+
+			~PoolResource() noexcept override
+			{
+				release();
+			}
+
+			PoolResource(const PoolResource &) = delete;
+			PoolResource &operator=(const PoolResource &) = delete;
+
+			// returns every slab upstream, invalidates all blocks handed out so far
+			void release() noexcept
+			{
+				while (m_pSlabs)
+				{
+					Slab *pSlab = m_pSlabs;
+					m_pSlabs = pSlab->pNext;
+					m_pUpstream->deallocate(pSlab, pSlab->nBytes, alignof(Slab));
+				}
+
+				for (Node *&pFree : m_aFree)
+					pFree = nullptr;
+			}
+
+		private:
+			static size_t classOf(const size_t nBytes) noexcept
+			{
+				const size_t nBits = nBytes > 1 ? std::bit_width(nBytes - 1) : 0;
+				return nBits < nMinBlockBits ? 0 : nBits - nMinBlockBits;
+			}
+
+			static bool isPooled(const size_t nBytes, const size_t nAlignment) noexcept
+			{
+				return nBytes <= (size_t(1) << nMaxBlockBits) && nAlignment <= alignof(std::max_align_t);
+			}
+
+			// carves a new slab into blocks of the given class
+			void refill(const size_t nClass)
+			{
+				const size_t nBlockBytes = size_t(1) << (nClass + nMinBlockBits);
+				const size_t nBlocks = std::max<size_t>(nSlabBytes / nBlockBytes, 4);
+				const size_t nBytes = sizeof(Slab) + nBlocks * nBlockBytes;
+
+				Slab *pSlab = static_cast<Slab *>(m_pUpstream->allocate(nBytes, alignof(Slab)));
+				pSlab->pNext = m_pSlabs;
+				pSlab->nBytes = nBytes;
+				m_pSlabs = pSlab;
+
+				std::byte *pBlock = reinterpret_cast<std::byte *>(pSlab + 1);
+				for (size_t i = 0; i < nBlocks; i++, pBlock += nBlockBytes)
+					m_aFree[nClass] = new (pBlock) Node{ m_aFree[nClass] };
+			}
+
+		protected:
+			void *do_allocate(const size_t nBytes, const size_t nAlignment) override
+			{
+				if (!isPooled(nBytes, nAlignment))
+					return m_pUpstream->allocate(nBytes, nAlignment);
+
+				const size_t nClass = classOf(nBytes);
+				if (!m_aFree[nClass])
+					refill(nClass);
+
+				Node *pNode = m_aFree[nClass];
+				m_aFree[nClass] = pNode->pNext;
+				return pNode;
+			}
+
+			void do_deallocate(void *p, const size_t nBytes, const size_t nAlignment) override
+			{
+				if (!isPooled(nBytes, nAlignment))
+					return m_pUpstream->deallocate(p, nBytes, nAlignment);
+
+				const size_t nClass = classOf(nBytes);
+				m_aFree[nClass] = new (p) Node{ m_aFree[nClass] };
+			}
+
+			bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+			{
+				return this == &other;
+			}
+		};
+
+		// the pool of the calling thread. it is not installed by default; anything allocated from it
+		// has to be destroyed on the same thread and before the thread exits
+		inline PoolResource &pool() noexcept
+		{
+			thread_local PoolResource threadPool;
+			return threadPool;
+		}
+
+		// bump allocator that frees everything at once at the end of the scope, deallocation is a no-op.
+		// meant for bursts of temporaries such as one round of a primality test
+		class Arena
+		{
+		private:
+			std::pmr::monotonic_buffer_resource m_resource;
+			ScopedResource m_scope;
+
+		public:
+			explicit Arena(const size_t nInitialBytes = 16384) noexcept
+				: m_resource(nInitialBytes, resource()), m_scope(&m_resource)
+			{}
+
+			Arena(const Arena &) = delete;
+			Arena &operator=(const Arena &) = delete;
+		};
+	}
+}
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "kernels.h"
+#include "allocator.h"
+#include "multiplication.h"
+#include <algorithm>
+#include <bit>
+
+namespace math
+{
+	// reciprocals of fewer limbs are computed by long division instead of newton iteration
+	inline size_t g_nReciprocalThreshold = 48;
+
+	namespace div
+	{
+		// knuth's algorithm D (TAOCP vol. 2, 4.3.1) on 64 bit limbs
+		// q[0, na - nb + 1) = a / b and r[0, nb) = a % b with na >= nb, b[nb - 1] != 0 and nb >= 2.
+		// either output may be nullptr, both may alias a or b because the operands are copied into
+		// the scratch space of na + 1 + nb limbs first
+		constexpr void divmod(int_t *q, int_t *r, const int_t *a, const size_t na, const int_t *b, const size_t nb, int_t *scratch) noexcept
+		{
+			const unsigned nShift = std::countl_zero(b[nb - 1].u64);
+
+			// normalize so that the top bit of the divisor is set
+			int_t *an = scratch;
+			int_t *bn = an + na + 1;
+			if (nShift)
+			{
+				kernel::lshift(bn, b, nb, nShift);
+				an[na].u64 = kernel::lshift(an, a, na, nShift);
+			}
+			else
+			{
+				std::copy(b, b + nb, bn);
+				std::copy(a, a + na, an);
+				an[na] = 0;
+			}
+
+			const uint64_t d1 = bn[nb - 1].u64, d0 = bn[nb - 2].u64;
+
+			size_t j = na - nb + 1;
+			while (j-- != 0)
+			{
+				const uint64_t n2 = an[j + nb].u64, n1 = an[j + nb - 1].u64, n0 = an[j + nb - 2].u64;
+
+				// estimate from the top two limbs, at most two too large after the correction
+				uint64_t qhat, rhat;
+				bool bRhatOverflow = false;
+				if (n2 >= d1)
+				{
+					qhat = ~uint64_t(0);
+					rhat = n1 + d1;
+					bRhatOverflow = rhat < n1;
+				}
+				else
+					qhat = kernel::div128(n2, n1, d1, rhat);
+
+				while (!bRhatOverflow)
+				{
+					uint64_t hi;
+					const uint64_t lo = kernel::mul64(qhat, d0, hi);
+					if (hi < rhat || (hi == rhat && lo <= n0))
+						break;
+
+					qhat--;
+					rhat += d1;
+					bRhatOverflow = rhat < d1;
+				}
+
+				// multiply and subtract, add back in the rare case that qhat was still one too large
+				const uint64_t borrow = kernel::submul_1(an + j, bn, nb, qhat);
+				if (n2 < borrow)
+				{
+					qhat--;
+					an[j + nb].u64 = n2 - borrow + kernel::add_n(an + j, an + j, bn, nb);
+				}
+				else
+					an[j + nb] = n2 - borrow;
+
+				if (q) q[j] = qhat;
+			}
+
+			if (!r)
+				return;
+
+			if (nShift)
+				kernel::rshift(r, an, nb, nShift);
+			else
+				std::copy(an, an + nb, r);
+		}
+
+		inline void divmod(int_t *q, int_t *r, const int_t *a, const size_t na, const int_t *b, const size_t nb) noexcept
+		{
+			memory::vector<int_t> vScratch(na + 1 + nb, memory::resource());
+			divmod(q, r, a, na, b, nb, vScratch.data());
+		}
+
+		// x[0, n + 1) = floor(B^(2n) / d) for d[0, n) with the top bit set and B = 2^64. the reciprocal of the
+		// leading n / 2 + 2 limbs is exact to about half the digits, one newton step x (2 - d x / B^(2n))
+		// leaves an error of a few units which is corrected against the remainder
+		inline void reciprocalNormalized(int_t *x, const int_t *d, const size_t n) noexcept
+		{
+			if (n < g_nReciprocalThreshold)
+			{
+				memory::vector<int_t> vScratch((2 * n + 1) + (n + 2), memory::resource());
+				int_t *numerator = vScratch.data();
+				int_t *quotient = numerator + 2 * n + 1;
+				numerator[2 * n].u64 = 1;
+				divmod(quotient, nullptr, numerator, 2 * n + 1, d, n);
+				std::copy(quotient, quotient + n + 1, x);
+				return;
+			}
+
+			const size_t h = n / 2 + 2;
+			const size_t l = n - h;
+
+			memory::vector<int_t> vScratch(3 * (2 * n + 2), memory::resource());
+			int_t *t = vScratch.data();
+			int_t *c = t + 2 * n + 2;
+			int_t *u = c + 2 * n + 2;
+
+			std::fill(x, x + l, int_t(0));
+			reciprocalNormalized(x + l, d + l, h);
+
+			// e = |d x - B^(2n)| and the step moves x by x e / B^(2n) in the opposite direction
+			mul::multiply(t, d, n, x, n + 1);
+			const bool bAbove = t[2 * n].u64 != 0;
+			if (bAbove)
+				t[2 * n].u64--;
+			else
+			{
+				for (size_t i = 0; i < 2 * n; i++)
+					t[i].u64 = ~t[i].u64;
+				kernel::add_1(t, t, 2 * n, 1);
+			}
+
+			const size_t ne = kernel::normalized_size(t, 2 * n + 1);
+			if (n + 1 + ne > 2 * n)
+			{
+				mul::multiply(c, x, n + 1, t, ne);
+				const size_t nc = n + 1 + ne - 2 * n;
+				if (bAbove)
+					kernel::sub_1(x + nc, x + nc, n + 1 - nc, kernel::sub_n(x, x, c + 2 * n, nc));
+				else
+					kernel::add_1(x + nc, x + nc, n + 1 - nc, kernel::add_n(x, x, c + 2 * n, nc));
+			}
+
+			// d x <= B^(2n) < d (x + 1)
+			const auto exceeds = [n](const int_t *v)
+			{
+				return v[2 * n].u64 > 1 || (v[2 * n].u64 == 1 && kernel::normalized_size(v, 2 * n) != 0);
+			};
+
+			mul::multiply(u, d, n, x, n + 1);
+			while (exceeds(u))
+			{
+				kernel::sub_1(x, x, n + 1, 1);
+				kernel::sub_1(u + n, u + n, n + 1, kernel::sub_n(u, u, d, n));
+			}
+
+			for (;;)
+			{
+				std::copy(u, u + 2 * n + 1, t);
+				kernel::add_1(t + n, t + n, n + 1, kernel::add_n(t, t, d, n));
+				if (exceeds(t))
+					break;
+				kernel::add_1(x, x, n + 1, 1);
+				std::copy(t, t + 2 * n + 1, u);
+			}
+		}
+
+		// mu[0, m + 2) = floor(B^(2m) / p) for p[0, m) with p[m - 1] != 0, the divisor of barrett reduction.
+		// with p normalized to p' = p 2^s B of m + 1 limbs, floor(B^(2m + 2) / p') = floor(B^(2m) / p 2^(64 - s))
+		inline void reciprocal(int_t *mu, const int_t *p, const size_t m) noexcept
+		{
+			const unsigned nShift = std::countl_zero(p[m - 1].u64);
+
+			memory::vector<int_t> vScratch((m + 1) + (m + 3), memory::resource());
+			int_t *pn = vScratch.data();
+			int_t *x = pn + m + 1;
+			if (nShift)
+				kernel::lshift(pn + 1, p, m, nShift);
+			else
+				std::copy(p, p + m, pn + 1);
+
+			reciprocalNormalized(x, pn, m + 1);
+			x[m + 2].u64 = nShift ? kernel::lshift(x, x, m + 2, nShift) : 0;
+			std::copy(x + 1, x + m + 3, mu);
+		}
+	}
+
+	// a single limb divisor together with its reciprocal, for dividing many numbers by the same value.
+	// a zero divisor is kept but must not be divided by
+	class SmallDivisor
+	{
+	private:
+		uint64_t m_nDivisor = 0;
+		uint64_t m_nNormalized = 0;
+		uint64_t m_nInverse = 0;
+		unsigned m_nShift = 0;
+
+	public:
+		constexpr SmallDivisor() noexcept = default;
+
+		constexpr explicit SmallDivisor(const uint64_t nDivisor) noexcept
+		{
+			m_nDivisor = nDivisor;
+			if (nDivisor == 0)
+				return;
+
+			m_nShift = std::countl_zero(nDivisor);
+			m_nNormalized = nDivisor << m_nShift;
+			m_nInverse = kernel::reciprocal_1(m_nNormalized);
+		}
+
+	public:
+		[[nodiscard]] constexpr uint64_t divisor() const noexcept
+		{
+			return m_nDivisor;
+		}
+
+		// q = a / divisor, returns a % divisor; q may be nullptr or equal a
+		constexpr uint64_t divrem(int_t *q, const int_t *a, const size_t n) const noexcept
+		{
+			return kernel::divrem_1_preinv(q, a, n, m_nNormalized, m_nInverse, m_nShift);
+		}
+	};
+}
@@ -1,130 +1,48 @@
 #pragma once
 
 #include "BigInt.h"
+#include "BigSInt.h"
+#include <utility>
 
 
 namespace eucl
 {
+	// the operands may come in either order
 	math::BigInt ggT(const math::BigInt &larger, const math::BigInt &smaller) noexcept
 	{
-		math::BigInt a = larger, b = smaller, r = 0, r_old{};
-
-		do
-		{
-			r_old = r;
-			r = a % b;
-			a = b;
-			b = r;
-		} while (r != 0);
-
-		return r_old;
+		return gcd(larger, smaller);
 	}
 
-	struct maybe_negative
+	struct Bezout
 	{
-		math::BigInt value;
-		bool bNegative = false;
-
-	public:
-		maybe_negative() noexcept = default;
-
-		maybe_negative(const math::BigInt &n, bool bNegative = false)
-		{
-			value = n;
-			this->bNegative = bNegative;
-		}
-
-	public:
-		bool isNegative() const noexcept
-		{
-			return bNegative;
-		}
-
-		math::BigInt get() const noexcept
-		{
-			return value;
-		}
-
-	public:
-		maybe_negative operator*(const math::BigInt &rhs) const noexcept
-		{
-			return maybe_negative(get() * rhs, bNegative);
-		}
-
-		maybe_negative operator-(const maybe_negative &rhs) const noexcept
-		{
-			if (isNegative() && rhs.isNegative())
-			{
-				// (-x0) - (-x1) = (-x0) + x1 = x1 - x0
-				return maybe_negative(rhs.get()) - maybe_negative(get());
-			}
-			else if (!isNegative() && rhs.isNegative())
-			{
-				// x0 - (-x1) = x0 + x1
-				return maybe_negative(get() + rhs.get());
-			}
-			else if (isNegative() && !rhs.isNegative())
-			{
-				// (-x0) - x1 = (-x0) + (-x1) = -(x0 + x1)
-				return maybe_negative(rhs.get() + get(), true);
-			}
-
-			// else (!isNegative() && !rhs.isNegative())
-			// x0 - x1
-
-			if (get() >= rhs.get()) // get() - rhs.get() cant be negative
-				return maybe_negative(get() - rhs.get());
-
-			// get() - rhs.get() is negative
-			return maybe_negative(rhs.get() - get(), true);
-		}
-
-		friend std::ostream &operator<<(std::ostream &os, const maybe_negative &i) noexcept
-		{
-			if (i.isNegative()) os << "-";
-			os << i.get();
-
-			return os;
-		}
-	};
-
-	struct Entry
-	{
-		math::BigInt a, b, q, r;
-		maybe_negative x, y;
+		math::BigInt g;
+		math::BigSInt x, y;
 	};
 
-	math::BigInt ext_euclidean(const math::BigInt &a, const math::BigInt &b)
+	// g = gcd(a, b) = x a + y b
+	Bezout bezout(const math::BigInt &a, const math::BigInt &b)
 	{
-		std::vector<Entry> vEntries{};
-
-		math::BigInt q, r;
-		math::BigInt::divmod(a, b, q, r);
-		vEntries.push_back({ a, b, q, r });
+		math::BigInt r0 = a, r1 = b, q, r;
+		math::BigSInt x0 = 1, x1 = 0, y0 = 0, y1 = 1;
 
-		while (r != 0)
+		while (!(r1 == 0))
 		{
-			Entry entry{ vEntries.at(vEntries.size() - 1).b, vEntries.at(vEntries.size() - 1).r };
-			math::BigInt::divmod(entry.a, entry.b, q, r);
-			entry.q = q;
-			entry.r = r;
-			vEntries.push_back(entry);
+			math::BigInt::divmod(r0, r1, q, r);
+			const math::BigSInt quotient = math::BigSInt(std::move(q));
+			x0 -= quotient * x1;
+			y0 -= quotient * y1;
+			std::swap(x0, x1);
+			std::swap(y0, y1);
+			r0 = std::move(r1);
+			r1 = std::move(r);
 		}
 
-		size_t i = vEntries.size() - 1;
-		vEntries.at(i).x = math::BigInt(0);
-		vEntries.at(i).y = math::BigInt(1);
-
-		while (i-- != 0)
-		{
-			vEntries.at(i).x = vEntries.at(i + 1).y;
-			maybe_negative negativeOffset = vEntries.at(i + 1).y * vEntries.at(i).q;
-			maybe_negative newy = vEntries.at(i + 1).x - negativeOffset;
-			vEntries.at(i).y = newy;
-		}
+		return Bezout{ r0, x0, y0 };
+	}
 
-		if (vEntries.at(0).x.isNegative())
-			return b - vEntries.at(0).x.get();
-		return vEntries.at(0).x.get();
+	// inverse of a modulo b, 0 if there is none
+	math::BigInt ext_euclidean(const math::BigInt &a, const math::BigInt &b)
+	{
+		return modinv(a, b).value_or(math::BigInt(0));
 	}
 }
@@ -9,5 +9,9 @@ namespace math
 		struct unrecognized_char : base_error{};
 
 		struct out_of_bounds : base_error{};
+
+		struct division_by_zero : base_error{};
+
+		struct invalid_modulus : base_error{};
 	}
 }
@@ -0,0 +1,333 @@
+#pragma once
+
+#include "kernels.h"
+#include "allocator.h"
+#include "division.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+namespace math
+{
+	// from this many limbs of the smaller operand on lehmer's algorithm is used, binary gcd below
+	inline size_t g_nLehmerGcdThreshold = 3;
+
+	namespace euclid
+	{
+		// stein's binary gcd on single limbs
+		constexpr uint64_t gcd_1(uint64_t a, uint64_t b) noexcept
+		{
+			if (a == 0) return b;
+			if (b == 0) return a;
+
+			const int k = std::countr_zero(a | b);
+			a >>= std::countr_zero(a);
+			while (b != 0)
+			{
+				b >>= std::countr_zero(b);
+				if (a > b) std::swap(a, b);
+				b -= a;
+			}
+			return a << k;
+		}
+
+		// trailing zero bits of x[0, n) != 0
+		constexpr size_t trailingZeros(const int_t *x) noexcept
+		{
+			size_t i = 0;
+			while (x[i].u64 == 0) i++;
+			return 64 * i + std::countr_zero(x[i].u64);
+		}
+
+		// divides x[0, n) != 0 by its largest power of two in place, returns the new size
+		constexpr size_t removeTwos(int_t *x, size_t n) noexcept
+		{
+			const size_t nZeros = trailingZeros(x);
+			if (nZeros / 64)
+			{
+				std::copy(x + nZeros / 64, x + n, x);
+				n -= nZeros / 64;
+			}
+			if (nZeros % 64)
+				kernel::rshift(x, x, n, unsigned(nZeros % 64));
+			return kernel::normalized_size(x, n);
+		}
+
+		// binary gcd of x[0, nx) and y[0, ny), both non zero and normalized. both are destroyed, the
+		// result is left in one of them without its common power of two 2^k; returns its size
+		constexpr size_t binary(int_t *&x, size_t nx, int_t *&y, size_t ny, size_t &k) noexcept
+		{
+			k = std::min(trailingZeros(x), trailingZeros(y));
+			nx = removeTwos(x, nx);
+			while (true)
+			{
+				ny = removeTwos(y, ny);
+				if (nx == 1 && ny == 1)
+				{
+					x[0].u64 = gcd_1(x[0].u64, y[0].u64);
+					return 1;
+				}
+
+				// both odd, the difference of the smaller from the larger is even
+				if (nx > ny || (nx == ny && kernel::cmp(x, y, nx) > 0))
+				{
+					std::swap(x, y);
+					std::swap(nx, ny);
+				}
+
+				const uint64_t borrow = kernel::sub_n(y, y, x, nx);
+				kernel::sub_1(y + nx, y + nx, ny - nx, borrow);
+				ny = kernel::normalized_size(y, ny);
+				if (ny == 0)
+					return nx;
+			}
+		}
+
+		// 64 bits of x[0, n) starting at bit nShift
+		constexpr uint64_t bitsAt(const int_t *x, const size_t n, const size_t nShift) noexcept
+		{
+			const size_t i = nShift / 64;
+			const unsigned s = unsigned(nShift % 64);
+			uint64_t bits = i < n ? x[i].u64 >> s : 0;
+			if (s && i + 1 < n)
+				bits |= x[i + 1].u64 << (64 - s);
+			return bits;
+		}
+
+		// cofactor matrix of the euclidean steps that the leading 62 bits of x >= y determine, after
+		// lehmer (knuth, TAOCP vol. 2, 4.5.2 L). returns the number of steps, 0 if not even one
+		constexpr size_t lehmerMatrix(const int_t *x, const size_t nx, const int_t *y, const size_t ny, int64_t &A, int64_t &B, int64_t &C, int64_t &D) noexcept
+		{
+			const size_t nBits = 64 * nx - std::countl_zero(x[nx - 1].u64);
+			const size_t nShift = nBits > 62 ? nBits - 62 : 0;
+			int64_t ah = int64_t(bitsAt(x, nx, nShift));
+			int64_t bh = int64_t(bitsAt(y, ny, nShift));
+
+			A = 1, B = 0, C = 0, D = 1;
+			size_t nSteps = 0;
+			while (bh + C != 0 && bh + D != 0)
+			{
+				const int64_t q = (ah + A) / (bh + C);
+				if (q != (ah + B) / (bh + D))
+					break;
+
+				int64_t T = A - q * C;
+				A = C;
+				C = T;
+				T = B - q * D;
+				B = D;
+				D = T;
+				T = ah - q * bh;
+				ah = bh;
+				bh = T;
+				nSteps++;
+			}
+			return nSteps;
+		}
+
+		// r[0, n) = p x - q y, known to be non negative and below B^n, so everything can wrap
+		constexpr void combine(int_t *r, const int_t *x, const int_t *y, const size_t n, const uint64_t p, const uint64_t q) noexcept
+		{
+			kernel::mul_1(r, x, n, p);
+			kernel::submul_1(r, y, n, q);
+		}
+
+		// r = A x + B y for a row of the cofactor matrix, whose entries never have the same sign
+		constexpr void combine(int_t *r, const int_t *x, const int_t *y, const size_t n, const int64_t A, const int64_t B) noexcept
+		{
+			if (B <= 0)
+				combine(r, x, y, n, uint64_t(A), uint64_t(-B));
+			else
+				combine(r, y, x, n, uint64_t(B), uint64_t(-A));
+		}
+
+		// r = gcd(a[0, na), b[0, nb)) with room for max(na, nb) limbs, returns its size. above the threshold
+		// lehmer's algorithm runs the euclidean steps on the leading 62 bits and applies them to the full
+		// numbers with a 2x2 cofactor matrix, binary gcd finishes
+		inline size_t gcd(int_t *r, const int_t *a, size_t na, const int_t *b, size_t nb) noexcept
+		{
+			na = kernel::normalized_size(a, na);
+			nb = kernel::normalized_size(b, nb);
+			if (na < nb || (na == nb && kernel::cmp(a, b, na) < 0))
+			{
+				std::swap(a, b);
+				std::swap(na, nb);
+			}
+
+			if (nb == 0)
+			{
+				std::copy(a, a + na, r);
+				return na;
+			}
+
+			if (nb == 1)
+			{
+				r[0].u64 = gcd_1(b[0].u64, kernel::divrem_1(nullptr, a, na, b[0].u64));
+				return 1;
+			}
+
+			memory::vector<int_t> vScratch(4 * na, memory::resource());
+			int_t *x = vScratch.data();
+			int_t *y = x + na;
+			int_t *t = y + na;
+			int_t *u = t + na;
+			std::copy(a, a + na, x);
+			std::copy(b, b + nb, y);
+			std::fill(y + nb, y + na, int_t(0));
+
+			// x >= y holds throughout, both are valid in [0, na)
+			const size_t nThreshold = std::max<size_t>(g_nLehmerGcdThreshold, 2);
+			while (nb >= nThreshold)
+			{
+				int64_t A, B, C, D;
+				if (lehmerMatrix(x, na, y, nb, A, B, C, D) == 0)
+				{
+					// the leading bits don't determine a single quotient, one full division step
+					div::divmod(nullptr, t, x, na, y, nb);
+					std::swap(x, y);
+					std::swap(y, t);
+					na = nb;
+				}
+				else
+				{
+					combine(t, x, y, na, A, B);
+					combine(u, x, y, na, C, D);
+					std::swap(x, t);
+					std::swap(y, u);
+					na = kernel::normalized_size(x, na);
+				}
+
+				nb = kernel::normalized_size(y, na);
+				if (nb == 0)
+				{
+					std::copy(x, x + na, r);
+					return na;
+				}
+			}
+
+			if (nb == 1)
+			{
+				r[0].u64 = gcd_1(y[0].u64, kernel::divrem_1(nullptr, x, na, y[0].u64));
+				return 1;
+			}
+
+			size_t k = 0;
+			const size_t n = binary(x, na, y, nb, k);
+			std::fill(r, r + k / 64, int_t(0));
+			if (k % 64)
+			{
+				const uint64_t carry = kernel::lshift(r + k / 64, x, n, unsigned(k % 64));
+				if (carry)
+				{
+					r[k / 64 + n].u64 = carry;
+					return k / 64 + n + 1;
+				}
+			}
+			else
+				std::copy(x, x + n, r + k / 64);
+			return k / 64 + n;
+		}
+
+		// r[0, nm) = a^-1 mod m for a[0, na) and m[0, nm) > 1, false if gcd(a, m) != 1. the extended
+		// euclidean algorithm runs forward: x = t0 a and y = t1 a mod m hold for the remainders x > y, only
+		// the magnitudes of t0 and t1 are kept because their signs alternate. lehmer steps as in gcd
+		inline bool modinv(int_t *r, const int_t *a, size_t na, const int_t *m, size_t nm) noexcept
+		{
+			na = kernel::normalized_size(a, na);
+			nm = kernel::normalized_size(m, nm);
+
+			memory::vector<int_t> vScratch(8 * nm + (nm + 1) + (2 * nm + 1), memory::resource());
+			int_t *x = vScratch.data(), *y = x + nm, *t = y + nm, *u = t + nm;
+			int_t *t0 = u + nm, *t1 = t0 + nm, *t2 = t1 + nm, *t3 = t2 + nm;
+			int_t *q = t3 + nm;
+			int_t *p = q + nm + 1;
+
+			std::copy(m, m + nm, x);
+			if (na < nm)
+			{
+				std::copy(a, a + na, y);
+				std::fill(y + na, y + nm, int_t(0));
+			}
+			else if (nm == 1)
+				y[0].u64 = kernel::divrem_1(nullptr, a, na, m[0].u64);
+			else
+				div::divmod(nullptr, y, a, na, m, nm);
+			t1[0].u64 = 1;
+
+			// t0 starts at 0, counted as negative so that it is opposite to t1
+			bool bNegative0 = true;
+			size_t nx = nm, ny = kernel::normalized_size(y, nm);
+			const size_t nThreshold = std::max<size_t>(g_nLehmerGcdThreshold, 2);
+			while (ny != 0)
+			{
+				int64_t A, B, C, D;
+				const size_t nSteps = ny >= nThreshold ? lehmerMatrix(x, nx, y, ny, A, B, C, D) : 0;
+				if (nSteps != 0)
+				{
+					combine(t, x, y, nx, A, B);
+					combine(u, x, y, nx, C, D);
+					std::swap(x, t);
+					std::swap(y, u);
+
+					// |A t0 + B t1| = |A| |t0| + |B| |t1| because the signs alternate
+					kernel::mul_1(t2, t0, nm, uint64_t(A < 0 ? -A : A));
+					kernel::addmul_1(t2, t1, nm, uint64_t(B < 0 ? -B : B));
+					kernel::mul_1(t3, t0, nm, uint64_t(C < 0 ? -C : C));
+					kernel::addmul_1(t3, t1, nm, uint64_t(D < 0 ? -D : D));
+					std::swap(t0, t2);
+					std::swap(t1, t3);
+					bNegative0 ^= (nSteps & 1) != 0;
+
+					nx = kernel::normalized_size(x, nx);
+					ny = kernel::normalized_size(y, nx);
+					continue;
+				}
+
+				// x, y = y, x mod y and t0, t1 = t1, t0 + q t1 for q = x / y
+				const size_t nq = nx - ny + 1;
+				if (ny == 1)
+				{
+					t[0].u64 = kernel::divrem_1(q, x, nx, y[0].u64);
+					std::fill(t + 1, t + nx, int_t(0));
+				}
+				else
+				{
+					div::divmod(q, t, x, nx, y, ny);
+					std::fill(t + ny, t + nx, int_t(0));
+				}
+
+				std::copy(t0, t0 + nm, t2);
+				const size_t nq1 = kernel::normalized_size(q, nq);
+				const size_t nt1 = kernel::normalized_size(t1, nm);
+				if (nq1 == 1)
+					kernel::addmul_1(t2, t1, nm, q[0].u64);
+				else
+				{
+					mul::multiply(p, q, nq1, t1, nt1);
+					const size_t np = std::min(nq1 + nt1, nm);
+					kernel::add_1(t2 + np, t2 + np, nm - np, kernel::add_n(t2, t2, p, np));
+				}
+
+				std::swap(x, y);
+				std::swap(y, t);
+				std::swap(t0, t1);
+				std::swap(t1, t2);
+				bNegative0 = !bNegative0;
+				nx = ny;
+				ny = kernel::normalized_size(y, nx);
+			}
+
+			if (nx != 1 || x[0].u64 != 1)
+				return false;
+
+			// a t0 = 1 mod m with |t0| < m
+			if (bNegative0)
+				kernel::sub_n(r, m, t0, nm);
+			else
+				std::copy(t0, t0 + nm, r);
+			return true;
+		}
+	}
+}
@@ -0,0 +1,394 @@
+#pragma once
+
+#include "int_type.h"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <type_traits>
+
+// add with carry instructions for the long additions and subtractions
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#define _BIGINT_ADDCARRY_
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <x86intrin.h>
+#define _BIGINT_ADDCARRY_
+#endif
+
+namespace math
+{
+	// low level routines on little endian limb spans; the caller owns the memory.
+	// everything is constexpr so that fixed width types can be evaluated at compile time
+	namespace kernel
+	{
+		constexpr uint64_t mul64(const uint64_t a, const uint64_t b, uint64_t &hi) noexcept
+		{
+#if defined(_MSC_VER) && defined(_M_X64)
+			if (!std::is_constant_evaluated())
+			{
+#ifdef __AVX2__
+				// every cpu with avx2 has bmi2, mulx leaves the flags alone
+				unsigned __int64 high;
+				const uint64_t lo = _mulx_u64(a, b, &high);
+				hi = high;
+				return lo;
+#else
+				return _umul128(a, b, &hi);
+#endif
+			}
+#endif
+#if defined(__SIZEOF_INT128__)
+			const unsigned __int128 product = (unsigned __int128)a * b;
+			hi = static_cast<uint64_t>(product >> 64);
+			return static_cast<uint64_t>(product);
+#else
+			const uint64_t a0 = static_cast<uint32_t>(a), a1 = a >> 32;
+			const uint64_t b0 = static_cast<uint32_t>(b), b1 = b >> 32;
+			const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+			const uint64_t mid = (p00 >> 32) + static_cast<uint32_t>(p01) + static_cast<uint32_t>(p10);
+			hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+			return (mid << 32) | static_cast<uint32_t>(p00);
+#endif
+		}
+
+		// a * b + c + d, which always fits into 128 bits
+		constexpr uint64_t mac64(const uint64_t a, const uint64_t b, const uint64_t c, const uint64_t d, uint64_t &hi) noexcept
+		{
+#if defined(__SIZEOF_INT128__)
+			const unsigned __int128 t = (unsigned __int128)a * b + c + d;
+			hi = static_cast<uint64_t>(t >> 64);
+			return static_cast<uint64_t>(t);
+#else
+			uint64_t lo = mul64(a, b, hi);
+			lo += c;
+			hi += lo < c;
+			lo += d;
+			hi += lo < d;
+			return lo;
+#endif
+		}
+
+		// (hi * 2^64 + lo) / d, requires hi < d
+		constexpr uint64_t div128(const uint64_t hi, const uint64_t lo, const uint64_t d, uint64_t &rem) noexcept
+		{
+#if defined(_MSC_VER) && defined(_M_X64)
+			if (!std::is_constant_evaluated())
+				return _udiv128(hi, lo, d, &rem);
+#endif
+#if defined(__SIZEOF_INT128__)
+			const unsigned __int128 n = (unsigned __int128)hi << 64 | lo;
+			rem = static_cast<uint64_t>(n % d);
+			return static_cast<uint64_t>(n / d);
+#else
+			// divlu from hacker's delight with 32 bit digits
+			constexpr uint64_t b = uint64_t(1) << 32;
+
+			const int s = std::countl_zero(d);
+			const uint64_t dn = d << s;
+			const uint64_t dn1 = dn >> 32, dn0 = static_cast<uint32_t>(dn);
+			const uint64_t un32 = s == 0 ? hi : (hi << s) | (lo >> (64 - s));
+			const uint64_t un10 = lo << s;
+			const uint64_t un1 = un10 >> 32, un0 = static_cast<uint32_t>(un10);
+
+			uint64_t q1 = un32 / dn1, rhat = un32 - q1 * dn1;
+			while (q1 >= b || q1 * dn0 > b * rhat + un1)
+			{
+				q1--;
+				rhat += dn1;
+				if (rhat >= b) break;
+			}
+
+			const uint64_t un21 = un32 * b + un1 - q1 * dn;
+			uint64_t q0 = un21 / dn1;
+			rhat = un21 - q0 * dn1;
+			while (q0 >= b || q0 * dn0 > b * rhat + un0)
+			{
+				q0--;
+				rhat += dn1;
+				if (rhat >= b) break;
+			}
+
+			rem = (un21 * b + un0 - q0 * dn) >> s;
+			return q1 * b + q0;
+#endif
+		}
+
+		// r = a + b, returns the carry
+		constexpr uint64_t add_n(int_t *r, const int_t *a, const int_t *b, const size_t n) noexcept
+		{
+#ifdef _BIGINT_ADDCARRY_
+			if (!std::is_constant_evaluated())
+			{
+				// unrolled so that the flag stays in place over four limbs
+				unsigned char carry = 0;
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4)
+				{
+					unsigned long long sum0, sum1, sum2, sum3;
+					carry = _addcarry_u64(carry, a[i].u64, b[i].u64, &sum0);
+					carry = _addcarry_u64(carry, a[i + 1].u64, b[i + 1].u64, &sum1);
+					carry = _addcarry_u64(carry, a[i + 2].u64, b[i + 2].u64, &sum2);
+					carry = _addcarry_u64(carry, a[i + 3].u64, b[i + 3].u64, &sum3);
+					r[i].u64 = sum0;
+					r[i + 1].u64 = sum1;
+					r[i + 2].u64 = sum2;
+					r[i + 3].u64 = sum3;
+				}
+				for (; i < n; i++)
+				{
+					unsigned long long sum;
+					carry = _addcarry_u64(carry, a[i].u64, b[i].u64, &sum);
+					r[i].u64 = sum;
+				}
+				return carry;
+			}
+#endif
+			uint64_t carry = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				const uint64_t s = a[i].u64 + carry;
+				carry = s < carry;
+				r[i].u64 = s + b[i].u64;
+				carry += r[i].u64 < s;
+			}
+			return carry;
+		}
+
+		// r = a + b, returns the carry
+		constexpr uint64_t add_1(int_t *r, const int_t *a, const size_t n, uint64_t b) noexcept
+		{
+			for (size_t i = 0; i < n; i++)
+			{
+				r[i].u64 = a[i].u64 + b;
+				b = r[i].u64 < b;
+			}
+			return b;
+		}
+
+		// r = a - b, returns the borrow
+		constexpr uint64_t sub_n(int_t *r, const int_t *a, const int_t *b, const size_t n) noexcept
+		{
+#ifdef _BIGINT_ADDCARRY_
+			if (!std::is_constant_evaluated())
+			{
+				// unrolled so that the flag stays in place over four limbs
+				unsigned char borrow = 0;
+				size_t i = 0;
+				for (; i + 4 <= n; i += 4)
+				{
+					unsigned long long difference0, difference1, difference2, difference3;
+					borrow = _subborrow_u64(borrow, a[i].u64, b[i].u64, &difference0);
+					borrow = _subborrow_u64(borrow, a[i + 1].u64, b[i + 1].u64, &difference1);
+					borrow = _subborrow_u64(borrow, a[i + 2].u64, b[i + 2].u64, &difference2);
+					borrow = _subborrow_u64(borrow, a[i + 3].u64, b[i + 3].u64, &difference3);
+					r[i].u64 = difference0;
+					r[i + 1].u64 = difference1;
+					r[i + 2].u64 = difference2;
+					r[i + 3].u64 = difference3;
+				}
+				for (; i < n; i++)
+				{
+					unsigned long long difference;
+					borrow = _subborrow_u64(borrow, a[i].u64, b[i].u64, &difference);
+					r[i].u64 = difference;
+				}
+				return borrow;
+			}
+#endif
+			uint64_t borrow = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				const uint64_t d = a[i].u64 - b[i].u64;
+				const uint64_t nBorrow = a[i].u64 < b[i].u64;
+				r[i].u64 = d - borrow;
+				borrow = nBorrow + (d < borrow);
+			}
+			return borrow;
+		}
+
+		// r = a - b, returns the borrow
+		constexpr uint64_t sub_1(int_t *r, const int_t *a, const size_t n, uint64_t b) noexcept
+		{
+			for (size_t i = 0; i < n; i++)
+			{
+				const uint64_t v = a[i].u64;
+				r[i].u64 = v - b;
+				b = v < b;
+			}
+			return b;
+		}
+
+		// r = a * b, returns the high limb
+		constexpr uint64_t mul_1(int_t *r, const int_t *a, const size_t n, const uint64_t b) noexcept
+		{
+			uint64_t carry = 0;
+			for (size_t i = 0; i < n; i++)
+				r[i].u64 = mac64(a[i].u64, b, carry, 0, carry);
+			return carry;
+		}
+
+		// r += a * b, returns the high limb
+		constexpr uint64_t addmul_1(int_t *r, const int_t *a, const size_t n, const uint64_t b) noexcept
+		{
+			uint64_t carry = 0;
+			for (size_t i = 0; i < n; i++)
+				r[i].u64 = mac64(a[i].u64, b, r[i].u64, carry, carry);
+			return carry;
+		}
+
+		// r -= a * b, returns the borrow out of the top limb
+		constexpr uint64_t submul_1(int_t *r, const int_t *a, const size_t n, const uint64_t b) noexcept
+		{
+			uint64_t carry = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				const uint64_t lo = mac64(a[i].u64, b, carry, 0, carry);
+				const uint64_t v = r[i].u64;
+				r[i].u64 = v - lo;
+				carry += v < lo;
+			}
+			return carry;
+		}
+
+		// r = a << nShift for 0 < nShift < 64, returns the bits shifted out
+		constexpr uint64_t lshift(int_t *r, const int_t *a, const size_t n, const unsigned nShift) noexcept
+		{
+			uint64_t carry = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				const uint64_t v = a[i].u64;
+				r[i].u64 = v << nShift | carry;
+				carry = v >> (64 - nShift);
+			}
+			return carry;
+		}
+
+		// r = a >> nShift for 0 < nShift < 64, r may equal a
+		constexpr void rshift(int_t *r, const int_t *a, const size_t n, const unsigned nShift) noexcept
+		{
+			for (size_t i = 0; i < n; i++)
+			{
+				const uint64_t next = i + 1 < n ? a[i + 1].u64 : 0;
+				r[i].u64 = a[i].u64 >> nShift | next << (64 - nShift);
+			}
+		}
+
+		// q = a / d, returns a % d; q may be nullptr if only the remainder is of interest
+		constexpr uint64_t divrem_1(int_t *q, const int_t *a, const size_t n, const uint64_t d) noexcept
+		{
+			uint64_t rem = 0;
+			size_t i = n;
+			while (i-- != 0)
+			{
+				const uint64_t quotient = div128(rem, a[i].u64, d, rem);
+				if (q) q[i].u64 = quotient;
+			}
+			return rem;
+		}
+
+		// floor((2^128 - 1) / d) - 2^64 for d with the top bit set
+		constexpr uint64_t reciprocal_1(const uint64_t d) noexcept
+		{
+			uint64_t rem = 0;
+			return div128(~d, ~uint64_t(0), d, rem);
+		}
+
+		// div128 for d with the top bit set and v = reciprocal_1(d), two multiplications instead of a
+		// hardware division (moeller, granlund: improved division by invariant integers)
+		constexpr uint64_t div128_preinv(const uint64_t hi, const uint64_t lo, const uint64_t d, const uint64_t v, uint64_t &rem) noexcept
+		{
+			uint64_t q1 = 0;
+			uint64_t q0 = mul64(v, hi, q1);
+			q0 += lo;
+			q1 += hi + 1 + (q0 < lo);
+
+			uint64_t r = lo - q1 * d;
+			if (r > q0)
+			{
+				q1--;
+				r += d;
+			}
+			if (r >= d)
+			{
+				q1++;
+				r -= d;
+			}
+
+			rem = r;
+			return q1;
+		}
+
+		// divrem_1 by d = dn >> nShift, where dn has the top bit set and v = reciprocal_1(dn). the
+		// dividend is shifted on the fly, q may be nullptr or equal a
+		constexpr uint64_t divrem_1_preinv(int_t *q, const int_t *a, const size_t n, const uint64_t dn, const uint64_t v, const unsigned nShift) noexcept
+		{
+			if (n == 0)
+				return 0;
+
+			uint64_t rem = nShift ? a[n - 1].u64 >> (64 - nShift) : 0;
+			size_t i = n;
+			while (i-- != 0)
+			{
+				const uint64_t word = nShift ? a[i].u64 << nShift | (i ? a[i - 1].u64 >> (64 - nShift) : 0) : a[i].u64;
+				const uint64_t quotient = div128_preinv(rem, word, dn, v, rem);
+				if (q) q[i].u64 = quotient;
+			}
+			return rem >> nShift;
+		}
+
+		// -1, 0 or 1 like memcmp, most significant limb first
+		constexpr int cmp(const int_t *a, const int_t *b, const size_t n) noexcept
+		{
+			size_t i = n;
+			while (i-- != 0)
+				if (a[i].u64 != b[i].u64)
+					return a[i].u64 < b[i].u64 ? -1 : 1;
+			return 0;
+		}
+
+		constexpr size_t normalized_size(const int_t *a, size_t n) noexcept
+		{
+			while (n > 0 && a[n - 1].u64 == 0)
+				n--;
+			return n;
+		}
+
+		// interleaved CIOS montgomery product r = a b 2^(-64 k) mod n for odd n of k limbs with
+		// nInverse = -n^-1 mod 2^64. t needs k + 1 limbs, r may alias a or b
+		constexpr void mont_mul(int_t *r, const int_t *a, const int_t *b, const int_t *n, const size_t k, const uint64_t nInverse, int_t *t) noexcept
+		{
+			std::fill(t, t + k + 1, int_t(0));
+
+			for (size_t i = 0; i < k; i++)
+			{
+				const uint64_t bi = b[i].u64;
+
+				uint64_t c1, c2;
+				const uint64_t lo = mac64(a[0].u64, bi, t[0].u64, 0, c1);
+
+				// m is chosen such that the lowest limb of t + a b_i + m n vanishes
+				const uint64_t m = lo * nInverse;
+				mac64(m, n[0].u64, lo, 0, c2);
+
+				for (size_t j = 1; j < k; j++)
+				{
+					const uint64_t v = mac64(a[j].u64, bi, t[j].u64, c1, c1);
+					t[j - 1] = mac64(m, n[j].u64, v, c2, c2);
+				}
+
+				uint64_t top = t[k].u64 + c1;
+				uint64_t carry = top < c1;
+				top += c2;
+				carry += top < c2;
+				t[k - 1] = top;
+				t[k] = carry;
+			}
+
+			// t < 2n
+			if (t[k].u64 || cmp(t, n, k) >= 0)
+				sub_n(r, t, n, k);
+			else
+				std::copy(t, t + k, r);
+		}
+	}
+}
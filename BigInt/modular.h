@@ -0,0 +1,531 @@
+#pragma once
+
+#include "BigInt.h"
+#include <algorithm>
+#include <span>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace math
+{
+	namespace window
+	{
+		constexpr size_t npos = ~size_t(0);
+
+		// window sizes as used by openssl, balancing the table setup against saved multiplications
+		constexpr size_t bitsFor(const size_t nExponentBits) noexcept
+		{
+			if (nExponentBits > 671) return 6;
+			if (nExponentBits > 239) return 5;
+			if (nExponentBits > 79)  return 4;
+			if (nExponentBits > 23)  return 3;
+			return 1;
+		}
+
+		// left to right sliding window decomposition of the exponent: step(nSquarings, nIndex) means
+		// "square nSquarings times, then multiply by base^(2 nIndex + 1)". the last step has nIndex == npos.
+		// the exponent can be any type with getBitCount() and getBit()
+		template <typename Exponent, typename Step>
+		constexpr void forEach(const Exponent &exponent, const size_t nWindowBits, Step step) noexcept
+		{
+			size_t nSquarings = 0;
+			size_t i = exponent.getBitCount();
+			while (i > 0)
+			{
+				if (!exponent.getBit(i - 1))
+				{
+					nSquarings++;
+					i--;
+					continue;
+				}
+
+				// the window [nLow, i) has to end with a set bit
+				size_t nLow = i > nWindowBits ? i - nWindowBits : 0;
+				while (!exponent.getBit(nLow))
+					nLow++;
+
+				size_t nValue = 0;
+				for (size_t nBit = i; nBit-- > nLow;)
+					nValue = nValue << 1 | size_t(exponent.getBit(nBit));
+
+				step(nSquarings + (i - nLow), (nValue - 1) / 2);
+				nSquarings = 0;
+				i = nLow;
+			}
+
+			step(nSquarings, npos);
+		}
+	}
+
+	// montgomery arithmetic for a fixed odd modulus n of k limbs with R = 2^(64 k).
+	// multiply, square and pow expect and return values in montgomery form (x R mod n, k limbs)
+	class MontgomeryContext
+	{
+	private:
+		BigInt m_modulus;
+		size_t m_nSize = 0;
+		uint64_t m_nInverse = 0; // -n^-1 mod 2^64
+		BigInt m_r2;             // R^2 mod n
+		BigInt m_one;            // R mod n
+
+		// the same modulus on 52 bit digits for the ifma kernel, nVectors = 0 if it isn't used
+		size_t m_nVectors = 0;
+		uint64_t m_nDigitInverse = 0;         // -n^-1 mod 2^52
+		std::vector<uint64_t> m_vDigitModulus;
+		std::vector<uint64_t> m_vDigitR2;     // R'^2 mod n for R' = 2^(416 nVectors)
+
+	public:
+		MontgomeryContext() noexcept = default;
+
+		explicit MontgomeryContext(const BigInt &modulus) BIGINT_NOEXCEPT
+		{
+			m_nSize = modulus.usedSize();
+
+#ifdef _BIGINT_EXCEPTIONS_
+			if (m_nSize == 0 || (modulus.getBlock(0).u64 & 1) == 0)
+				throw error::invalid_modulus{};
+#endif
+
+			m_modulus = modulus;
+			m_modulus.m_data.resize(m_nSize);
+
+			// newton iteration, every step doubles the number of correct low bits
+			const uint64_t n0 = m_modulus.getBlock(0).u64;
+			uint64_t inv = n0;
+			for (int i = 0; i < 5; i++)
+				inv *= 2 - n0 * inv;
+			m_nInverse = 0 - inv;
+
+			m_r2 = (BigInt(1) << (128 * m_nSize)) % m_modulus;
+			m_r2.m_data.resize(m_nSize);
+			m_one = multiply(m_r2, BigInt(1));
+
+			const size_t nBits = m_modulus.getBitCount();
+			if (simd::cpu().bAvx512Ifma && m_nSize >= g_nIfmaMontgomeryThreshold && simd::montVectors(nBits) <= simd::nMaxMontVectors)
+			{
+				m_nVectors = simd::montVectors(nBits);
+				m_nDigitInverse = m_nInverse & ((uint64_t(1) << 52) - 1);
+
+				const size_t nDigits = 8 * m_nVectors;
+				const BigInt r2 = (BigInt(1) << (2 * 52 * nDigits)) % m_modulus;
+				m_vDigitModulus.resize(nDigits);
+				m_vDigitR2.resize(nDigits);
+				simd::toDigits(m_vDigitModulus.data(), nDigits, m_modulus.m_data.data(), m_nSize, 52);
+				simd::toDigits(m_vDigitR2.data(), nDigits, r2.m_data.data(), r2.m_data.size(), 52);
+			}
+		}
+
+	private:
+		// r = a b R^-1 mod n, t needs k + 1 limbs. r may alias a or b
+		void redc(int_t *r, const int_t *a, const int_t *b, int_t *t) const noexcept
+		{
+			kernel::mont_mul(r, a, b, m_modulus.m_data.data(), m_nSize, m_nInverse, t);
+		}
+
+		BigInt redc(const BigInt &a, const BigInt &b) const noexcept
+		{
+			memory::vector<int_t> vScratch(3 * m_nSize + 1, memory::resource());
+			int_t *pa = vScratch.data();
+			int_t *pb = pa + m_nSize;
+			int_t *t = pb + m_nSize;
+			std::copy(a.m_data.data(), a.m_data.data() + std::min(a.m_data.size(), m_nSize), pa);
+			std::copy(b.m_data.data(), b.m_data.data() + std::min(b.m_data.size(), m_nSize), pb);
+
+			BigInt out;
+			out.m_data.resize(m_nSize);
+			redc(out.m_data.data(), pa, pb, t);
+			return out;
+		}
+
+	public:
+		[[nodiscard]] const BigInt &modulus() const noexcept
+		{
+			return m_modulus;
+		}
+
+		[[nodiscard]] size_t size() const noexcept
+		{
+			return m_nSize;
+		}
+
+		// montgomery form of 1
+		[[nodiscard]] const BigInt &one() const noexcept
+		{
+			return m_one;
+		}
+
+		[[nodiscard]] BigInt toMontgomery(const BigInt &x) const noexcept
+		{
+			if (x.usedSize() > m_nSize || !(x < m_modulus))
+				return redc(x % m_modulus, m_r2);
+			return redc(x, m_r2);
+		}
+
+		[[nodiscard]] BigInt fromMontgomery(const BigInt &x) const noexcept
+		{
+			return redc(x, BigInt(1));
+		}
+
+		[[nodiscard]] BigInt multiply(const BigInt &a, const BigInt &b) const noexcept
+		{
+			return redc(a, b);
+		}
+
+		[[nodiscard]] BigInt square(const BigInt &a) const noexcept
+		{
+			return redc(a, a);
+		}
+
+		// x^exponent with x in montgomery form, sliding window over the odd powers of x
+		[[nodiscard]] BigInt pow(const BigInt &x, const BigInt &exponent) const noexcept
+		{
+			const size_t k = m_nSize;
+			const size_t nWindowBits = window::bitsFor(exponent.getBitCount());
+			const size_t nTableSize = size_t(1) << (nWindowBits - 1);
+
+			memory::vector<int_t> vScratch((nTableSize + 2) * k + 1, memory::resource());
+			int_t *table = vScratch.data();
+			int_t *acc = table + nTableSize * k;
+			int_t *t = acc + k;
+
+			std::copy(x.m_data.data(), x.m_data.data() + std::min(x.m_data.size(), k), table);
+			if (nTableSize > 1)
+			{
+				redc(acc, table, table, t);
+				for (size_t i = 1; i < nTableSize; i++)
+					redc(table + i * k, table + (i - 1) * k, acc, t);
+			}
+
+			bool bStarted = false;
+			window::forEach(exponent, nWindowBits, [&](const size_t nSquarings, const size_t nIndex)
+			{
+				if (bStarted)
+					for (size_t i = 0; i < nSquarings; i++)
+						redc(acc, acc, acc, t);
+
+				if (nIndex == window::npos)
+					return;
+
+				if (bStarted)
+					redc(acc, acc, table + nIndex * k, t);
+				else
+					std::copy(table + nIndex * k, table + (nIndex + 1) * k, acc);
+				bStarted = true;
+			});
+
+			if (!bStarted)
+				return m_one;
+
+			BigInt out;
+			out.m_data.resize(k);
+			std::copy(acc, acc + k, out.m_data.data());
+			return out;
+		}
+
+	private:
+		// powmod on the ifma kernel. its products are only reduced below 2n, which is fixed once at the end
+		BigInt powmodIfma(const BigInt &base, const BigInt &exponent) const noexcept
+		{
+			const size_t nDigits = 8 * m_nVectors;
+			const size_t nWindowBits = window::bitsFor(exponent.getBitCount());
+			const size_t nTableSize = size_t(1) << (nWindowBits - 1);
+			const uint64_t *n = m_vDigitModulus.data();
+
+			memory::vector<uint64_t> vScratch((nTableSize + 2) * nDigits, memory::resource());
+			uint64_t *table = vScratch.data();
+			uint64_t *acc = table + nTableSize * nDigits;
+			uint64_t *x = acc + nDigits;
+
+			const BigInt reduced = base.usedSize() > m_nSize || !(base < m_modulus) ? base % m_modulus : base;
+			simd::toDigits(x, nDigits, reduced.m_data.data(), std::min(reduced.m_data.size(), m_nSize), 52);
+			simd::montMul(m_nVectors, table, x, m_vDigitR2.data(), n, m_nDigitInverse);
+			if (nTableSize > 1)
+			{
+				simd::montMul(m_nVectors, acc, table, table, n, m_nDigitInverse);
+				for (size_t i = 1; i < nTableSize; i++)
+					simd::montMul(m_nVectors, table + i * nDigits, table + (i - 1) * nDigits, acc, n, m_nDigitInverse);
+			}
+
+			bool bStarted = false;
+			window::forEach(exponent, nWindowBits, [&](const size_t nSquarings, const size_t nIndex)
+			{
+				if (bStarted)
+					for (size_t i = 0; i < nSquarings; i++)
+						simd::montMul(m_nVectors, acc, acc, acc, n, m_nDigitInverse);
+
+				if (nIndex == window::npos)
+					return;
+
+				if (bStarted)
+					simd::montMul(m_nVectors, acc, acc, table + nIndex * nDigits, n, m_nDigitInverse);
+				else
+					std::copy(table + nIndex * nDigits, table + (nIndex + 1) * nDigits, acc);
+				bStarted = true;
+			});
+
+			if (!bStarted)
+				return BigInt(1) % m_modulus;
+
+			// multiplying by 1 leaves normal form
+			std::fill(x, x + nDigits, uint64_t(0));
+			x[0] = 1;
+			simd::montMul(m_nVectors, acc, acc, x, n, m_nDigitInverse);
+
+			BigInt out;
+			out.m_data.resize(m_nSize + 1);
+			simd::fromColumns(out.m_data.data(), m_nSize + 1, acc, nDigits, 52);
+			if (!(out < m_modulus))
+				out -= m_modulus;
+			out.m_data.resize(m_nSize);
+			return out;
+		}
+
+	public:
+		// base^exponent mod n for a base in normal form
+		[[nodiscard]] BigInt powmod(const BigInt &base, const BigInt &exponent) const noexcept
+		{
+			if (m_nVectors)
+				return powmodIfma(base, exponent);
+			return fromMontgomery(pow(toMontgomery(base), exponent));
+		}
+	};
+
+	// barrett reduction for a fixed modulus m of k limbs with mu = floor(2^(128 k) / m),
+	// works for even moduli as well. values are kept in normal form. mu has k + 1 limbs, except for
+	// m = b^(k - 1) where it is b^(k + 1) and needs k + 2
+	class BarrettContext
+	{
+	private:
+		BigInt m_modulus;
+		size_t m_nSize = 0;
+		BigInt m_mu;
+
+	public:
+		BarrettContext() noexcept = default;
+
+		explicit BarrettContext(const BigInt &modulus) BIGINT_NOEXCEPT
+		{
+			m_nSize = modulus.usedSize();
+
+#ifdef _BIGINT_EXCEPTIONS_
+			if (m_nSize == 0)
+				throw error::invalid_modulus{};
+#endif
+
+			m_modulus = modulus;
+			m_modulus.m_data.resize(m_nSize);
+			m_mu = (BigInt(1) << (128 * m_nSize)) / m_modulus;
+			m_mu.m_data.resize(m_mu.usedSize());
+		}
+
+	public:
+		[[nodiscard]] const BigInt &modulus() const noexcept
+		{
+			return m_modulus;
+		}
+
+		// x mod m, two multiplications for any x < 2^(128 k), falls back to a division above
+		[[nodiscard]] BigInt reduce(const BigInt &x) const noexcept
+		{
+			const size_t k = m_nSize;
+			const size_t nx = x.usedSize();
+
+			if (nx < k)
+				return x;
+			if (nx > 2 * k)
+				return x % m_modulus;
+
+			// q3 = floor(floor(x / b^(k - 1)) mu / b^(k + 1)) underestimates x / m by at most 2
+			const size_t nq1 = nx - (k - 1);
+			const size_t nMu = m_mu.m_data.size();
+			memory::vector<int_t> vScratch((nq1 + nMu) + (nq1 + k) + (k + 1), memory::resource());
+			int_t *q2 = vScratch.data();
+			int_t *r2 = q2 + nq1 + nMu;
+			int_t *r = r2 + nq1 + k;
+
+			mul::multiply(q2, x.m_data.data() + k - 1, nq1, m_mu.m_data.data(), nMu);
+			mul::multiply(r2, q2 + k + 1, nq1, m_modulus.m_data.data(), k);
+
+			// r = (x - q3 m) mod b^(k + 1), at most two subtractions of m remain
+			std::copy(x.m_data.data(), x.m_data.data() + std::min(nx, k + 1), r);
+			kernel::sub_n(r, r, r2, k + 1);
+
+			const int_t *m = m_modulus.m_data.data();
+			for (size_t i = 0; i < 2 && (r[k].u64 || kernel::cmp(r, m, k) >= 0); i++)
+				r[k] -= kernel::sub_n(r, r, m, k);
+
+			BigInt out;
+			out.m_data.resize(k);
+			std::copy(r, r + k, out.m_data.data());
+			return out;
+		}
+
+		[[nodiscard]] BigInt multiply(const BigInt &a, const BigInt &b) const noexcept
+		{
+			return reduce(a * b);
+		}
+
+		[[nodiscard]] BigInt square(const BigInt &a) const noexcept
+		{
+			return reduce(a * a);
+		}
+
+		// base^exponent mod m with the same sliding window as the montgomery version
+		[[nodiscard]] BigInt powmod(const BigInt &base, const BigInt &exponent) const noexcept
+		{
+			const size_t nWindowBits = window::bitsFor(exponent.getBitCount());
+			std::vector<BigInt> vTable(size_t(1) << (nWindowBits - 1));
+			vTable[0] = reduce(base);
+			if (vTable.size() > 1)
+			{
+				const BigInt x2 = square(vTable[0]);
+				for (size_t i = 1; i < vTable.size(); i++)
+					vTable[i] = multiply(vTable[i - 1], x2);
+			}
+
+			BigInt out = reduce(BigInt(1));
+			bool bStarted = false;
+			window::forEach(exponent, nWindowBits, [&](const size_t nSquarings, const size_t nIndex)
+			{
+				if (bStarted)
+					for (size_t i = 0; i < nSquarings; i++)
+						out = square(out);
+
+				if (nIndex == window::npos)
+					return;
+
+				out = bStarted ? multiply(out, vTable[nIndex]) : vTable[nIndex];
+				bStarted = true;
+			});
+
+			return out;
+		}
+	};
+
+	// montgomery's trick: the inverses of n values from one inversion of their product and 3 (n - 1)
+	// multiplications. the prefix products are built in place of the inverses and consumed from the back
+	namespace batch
+	{
+		// vOut[i] = v[0] ... v[i] under the multiplication of the context
+		template <typename Context>
+		void prefix(const Context &context, std::span<const BigInt> v, std::span<BigInt> vOut) noexcept
+		{
+			vOut[0] = v[0];
+			for (size_t i = 1; i < v.size(); i++)
+				vOut[i] = context.multiply(vOut[i - 1], v[i]);
+		}
+
+		// u is the inverse of vOut.back(), afterwards vOut[i] = v[i]^-1. montgomery multiplication works
+		// as well: every product carries one factor R^-1 less, and those cancel in u vOut[i - 1]
+		template <typename Context>
+		void unwind(const Context &context, std::span<const BigInt> v, BigInt u, std::span<BigInt> vOut) noexcept
+		{
+			for (size_t i = v.size() - 1; i > 0; i--)
+			{
+				vOut[i] = context.multiply(u, vOut[i - 1]);
+				u = context.multiply(u, v[i]);
+			}
+			vOut[0] = std::move(u);
+		}
+
+		// chunks of v run prefix and unwind on their own threads, only the chunk products meet. the workers
+		// only allocate from their own thread's resource: each chunk is computed into a vector created on its
+		// thread, and the results are moved into vOut, whose elements may use a single threaded pool, on
+		// the calling thread. a thread that can't be started leaves its chunk to the calling thread
+		template <typename Context>
+		bool invert(const Context &context, const BigInt &modulus, std::span<const BigInt> v, std::span<BigInt> vOut, size_t nThreads) noexcept
+		{
+			nThreads = std::clamp<size_t>(nThreads, 1, v.size());
+			if (nThreads == 1)
+			{
+				prefix(context, v, vOut);
+				const std::optional<BigInt> inverse = modinv(vOut.back(), modulus);
+				if (!inverse)
+					return false;
+
+				unwind(context, v, *inverse, vOut);
+				return true;
+			}
+
+			const size_t nChunk = (v.size() + nThreads - 1) / nThreads;
+			const size_t nChunks = (v.size() + nChunk - 1) / nChunk;
+			auto forChunks = [&](auto function)
+			{
+				std::vector<std::thread> vThreads;
+				for (size_t j = 1; j < nChunks; j++)
+				{
+					try
+					{
+						vThreads.emplace_back(function, j);
+					}
+					catch (const std::system_error &)
+					{
+						function(j);
+					}
+				}
+				function(0);
+				for (std::thread &thread : vThreads)
+					thread.join();
+			};
+			auto chunk = [&](const auto &span, const size_t j)
+			{
+				return span.subspan(j * nChunk, std::min(nChunk, v.size() - j * nChunk));
+			};
+
+			std::vector<std::vector<BigInt>> vPartial(nChunks);
+			forChunks([&](const size_t j)
+			{
+				std::vector<BigInt> vLocal(chunk(v, j).size());
+				prefix(context, chunk(v, j), std::span<BigInt>(vLocal));
+				vPartial[j] = std::move(vLocal);
+			});
+
+			std::vector<BigInt> vProducts(nChunks), vInverses(nChunks);
+			for (size_t j = 0; j < nChunks; j++)
+				vProducts[j] = vPartial[j].back();
+			if (!invert(context, modulus, std::span<const BigInt>(vProducts), std::span<BigInt>(vInverses), 1))
+				return false;
+
+			forChunks([&](const size_t j) { unwind(context, chunk(v, j), vInverses[j], std::span<BigInt>(vPartial[j])); });
+			for (size_t j = 0; j < nChunks; j++)
+				std::move(vPartial[j].begin(), vPartial[j].end(), chunk(vOut, j).begin());
+			return true;
+		}
+	}
+
+	// vInverses[i] = vValues[i]^-1 mod m, the spans have the same size. false if a value has no inverse,
+	// the outputs are unspecified then. with nThreads > 1 the prefix products are built in parallel chunks
+	inline bool modinvBatch(std::span<const BigInt> vValues, const BigInt &modulus, std::span<BigInt> vInverses, const size_t nThreads = 1) noexcept
+	{
+		if (modulus == 0)
+			return false;
+		if (vValues.empty())
+			return true;
+
+		// the montgomery product needs reduced operands
+		std::vector<BigInt> vReduced;
+		const bool bReduce = std::any_of(vValues.begin(), vValues.end(), [&](const BigInt &x) { return !(x < modulus); });
+		if (bReduce)
+		{
+			vReduced.reserve(vValues.size());
+			for (const BigInt &x : vValues)
+				vReduced.push_back(x < modulus ? x : x % modulus);
+			vValues = vReduced;
+		}
+
+		if (modulus.getBlock(0).u64 & 1)
+			return batch::invert(MontgomeryContext(modulus), modulus, vValues, vInverses, nThreads);
+		return batch::invert(BarrettContext(modulus), modulus, vValues, vInverses, nThreads);
+	}
+
+	inline BigInt BigInt::powmod(const BigInt &exponent, const BigInt &modulus) const noexcept
+	{
+		if (modulus.getBitCount() < 2)
+			return BigInt(0);
+
+		if (modulus.getBlock(0).u64 & 1)
+			return MontgomeryContext(modulus).powmod(*this, exponent);
+		return BarrettContext(modulus).powmod(*this, exponent);
+	}
+}
@@ -0,0 +1,278 @@
+#pragma once
+
+#include "kernels.h"
+#include "allocator.h"
+#include "ntt.h"
+#include "simd.h"
+#include <algorithm>
+#include <array>
+
+namespace math
+{
+	// operand sizes (in limbs) from which on operator* switches to the next algorithm
+	inline size_t g_nKaratsubaThreshold = 24;
+	inline size_t g_nToom3Threshold     = 160;
+	inline size_t g_nNttThreshold       = 1536;
+
+	namespace mul
+	{
+		inline void multiply(int_t *r, const int_t *a, size_t na, const int_t *b, size_t nb) noexcept;
+
+		// r[0, na + nb) = a * b
+		inline void basecase(int_t *r, const int_t *a, const size_t na, const int_t *b, const size_t nb) noexcept
+		{
+			if (simd::basecase(r, a, na, b, nb))
+				return;
+
+			r[na] = kernel::mul_1(r, a, na, b[0].u64);
+			for (size_t j = 1; j < nb; j++)
+				r[na + j] = kernel::addmul_1(r + j, a, na, b[j].u64);
+		}
+
+		// r[0, nr) += x[0, nx), the sum has to fit into nr limbs
+		inline void addInto(int_t *r, const size_t nr, const int_t *x, size_t nx) noexcept
+		{
+			nx = kernel::normalized_size(x, nx);
+			const uint64_t carry = kernel::add_n(r, r, x, nx);
+			if (carry)
+				kernel::add_1(r + nx, r + nx, nr - nx, carry);
+		}
+
+		// a is split into chunks of nb limbs, each chunk is multiplied as a balanced product
+		inline void unbalanced(int_t *r, const int_t *a, const size_t na, const int_t *b, const size_t nb) noexcept
+		{
+			std::fill(r, r + na + nb, int_t(0));
+
+			memory::vector<int_t> vChunk(2 * nb, memory::resource());
+			for (size_t i = 0; i < na; i += nb)
+			{
+				const size_t nChunk = std::min(nb, na - i);
+				multiply(vChunk.data(), a + i, nChunk, b, nb);
+				addInto(r + i, na + nb - i, vChunk.data(), nChunk + nb);
+			}
+		}
+
+		// requires na >= nb > ceil(na / 2)
+		inline void karatsuba(int_t *r, const int_t *a, const size_t na, const int_t *b, const size_t nb) noexcept
+		{
+			const size_t m = (na + 1) / 2;
+			const size_t na1 = na - m, nb1 = nb - m;
+
+			// z0 and z2 go straight to their final place
+			multiply(r, a, m, b, m);
+			multiply(r + 2 * m, a + m, na1, b + m, nb1);
+
+			memory::vector<int_t> vScratch(4 * (m + 1), memory::resource());
+			int_t *sa = vScratch.data();
+			int_t *sb = sa + m + 1;
+			int_t *z1 = sb + m + 1;
+
+			uint64_t carry = kernel::add_n(sa, a, a + m, na1);
+			sa[m] = kernel::add_1(sa + na1, a + na1, m - na1, carry);
+			carry = kernel::add_n(sb, b, b + m, nb1);
+			sb[m] = kernel::add_1(sb + nb1, b + nb1, m - nb1, carry);
+
+			// z1 = (a0 + a1)(b0 + b1) - z0 - z2
+			multiply(z1, sa, m + 1, sb, m + 1);
+			uint64_t borrow = kernel::sub_n(z1, z1, r, 2 * m);
+			kernel::sub_1(z1 + 2 * m, z1 + 2 * m, 2, borrow);
+			borrow = kernel::sub_n(z1, z1, r + 2 * m, na1 + nb1);
+			kernel::sub_1(z1 + na1 + nb1, z1 + na1 + nb1, 2 * m + 2 - na1 - nb1, borrow);
+
+			addInto(r + m, na + nb - m, z1, 2 * m + 2);
+		}
+
+		namespace toom
+		{
+			// sign-magnitude value of fixed width used for evaluation and interpolation
+			struct Term
+			{
+				memory::vector<int_t> vMag;
+				bool bNegative = false;
+
+			public:
+				Term(const size_t nSize) noexcept
+					: vMag(nSize, memory::resource())
+				{
+				}
+
+				Term(const int_t *p, const size_t n, const size_t nSize) noexcept
+					: vMag(nSize, memory::resource())
+				{
+					std::copy(p, p + n, vMag.begin());
+				}
+
+				size_t size() const noexcept
+				{
+					return vMag.size();
+				}
+			};
+
+			// r = x + y or r = x - y, r may alias x or y
+			inline void addSigned(Term &r, const Term &x, const Term &y, const bool bSubtract) noexcept
+			{
+				const size_t n = r.size();
+				const bool bNegX = x.bNegative;
+				const bool bNegY = y.bNegative != bSubtract;
+
+				if (bNegX == bNegY)
+				{
+					kernel::add_n(r.vMag.data(), x.vMag.data(), y.vMag.data(), n);
+					r.bNegative = bNegX;
+				}
+				else if (kernel::cmp(x.vMag.data(), y.vMag.data(), n) >= 0)
+				{
+					kernel::sub_n(r.vMag.data(), x.vMag.data(), y.vMag.data(), n);
+					r.bNegative = bNegX;
+				}
+				else
+				{
+					kernel::sub_n(r.vMag.data(), y.vMag.data(), x.vMag.data(), n);
+					r.bNegative = bNegY;
+				}
+			}
+
+			inline void shiftLeft1(Term &t) noexcept
+			{
+				uint64_t carry = 0;
+				for (int_t &limb : t.vMag)
+				{
+					const uint64_t v = limb.u64;
+					limb.u64 = v << 1 | carry;
+					carry = v >> 63;
+				}
+			}
+
+			inline void shiftRight1(Term &t) noexcept
+			{
+				uint64_t carry = 0;
+				size_t i = t.size();
+				while (i-- != 0)
+				{
+					const uint64_t v = t.vMag[i].u64;
+					t.vMag[i].u64 = v >> 1 | carry;
+					carry = v << 63;
+				}
+			}
+
+			// t has to be a multiple of 3
+			inline void divExact3(Term &t) noexcept
+			{
+				constexpr uint64_t nInverse3 = 0xAAAAAAAAAAAAAAABull;
+
+				uint64_t borrow = 0;
+				for (int_t &limb : t.vMag)
+				{
+					const uint64_t v = limb.u64;
+					uint64_t q = v - borrow;
+					borrow = v < borrow;
+					q *= nInverse3;
+					limb.u64 = q;
+
+					uint64_t hi;
+					kernel::mul64(q, 3, hi);
+					borrow += hi;
+				}
+			}
+
+			inline Term product(const Term &x, const Term &y) noexcept
+			{
+				Term out = Term(x.size() + y.size());
+				multiply(out.vMag.data(), x.vMag.data(), x.size(), y.vMag.data(), y.size());
+				out.bNegative = x.bNegative != y.bNegative;
+				return out;
+			}
+
+			// evaluates a0 + a1 x + a2 x^2 at 0, 1, -1, -2 and infinity
+			inline std::array<Term, 5> evaluate(const int_t *a, const size_t na, const size_t k) noexcept
+			{
+				const size_t nSize = k + 1;
+				Term a0 = Term(a, k, nSize), a1 = Term(a + k, k, nSize), a2 = Term(a + 2 * k, na - 2 * k, nSize);
+
+				Term p0 = Term(nSize), p1 = Term(nSize), pm1 = Term(nSize), pm2 = Term(nSize);
+				addSigned(p0, a0, a2, false);
+				addSigned(p1, p0, a1, false);
+				addSigned(pm1, p0, a1, true);
+				addSigned(pm2, pm1, a2, false);
+				shiftLeft1(pm2);
+				addSigned(pm2, pm2, a0, true);
+
+				return { a0, p1, pm1, pm2, a2 };
+			}
+		}
+
+		// Toom-Cook 3 with Bodrato's interpolation sequence, requires na >= nb > 2 * ceil(na / 3)
+		inline void toom3(int_t *r, const int_t *a, const size_t na, const int_t *b, const size_t nb) noexcept
+		{
+			using toom::Term;
+
+			const size_t k = (na + 2) / 3;
+			const size_t nr = na + nb;
+
+			std::array<Term, 5> vA = toom::evaluate(a, na, k);
+			std::array<Term, 5> vB = toom::evaluate(b, nb, k);
+
+			Term w0   = toom::product(vA[0], vB[0]);
+			Term w1   = toom::product(vA[1], vB[1]);
+			Term wm1  = toom::product(vA[2], vB[2]);
+			Term wm2  = toom::product(vA[3], vB[3]);
+			Term winf = toom::product(vA[4], vB[4]);
+
+			Term r1 = Term(w0.size()), r2 = Term(w0.size()), r3 = Term(w0.size());
+
+			toom::addSigned(r3, wm2, w1, true);
+			toom::divExact3(r3);
+			toom::addSigned(r1, w1, wm1, true);
+			toom::shiftRight1(r1);
+			toom::addSigned(r2, wm1, w0, true);
+			toom::addSigned(r3, r2, r3, true);
+			toom::shiftRight1(r3);
+			Term winf2 = winf;
+			toom::shiftLeft1(winf2);
+			toom::addSigned(r3, r3, winf2, false);
+			toom::addSigned(r2, r2, r1, false);
+			toom::addSigned(r2, r2, winf, true);
+			toom::addSigned(r1, r1, r3, true);
+
+			// all coefficients are non-negative now, r0 and r4 do not overlap
+			std::fill(r, r + nr, int_t(0));
+			std::copy(w0.vMag.begin(), w0.vMag.begin() + 2 * k, r);
+			std::copy(winf.vMag.begin(), winf.vMag.begin() + (nr - 4 * k), r + 4 * k);
+			addInto(r + k, nr - k, r1.vMag.data(), r1.size());
+			addInto(r + 2 * k, nr - 2 * k, r2.vMag.data(), r2.size());
+			addInto(r + 3 * k, nr - 3 * k, r3.vMag.data(), r3.size());
+		}
+
+		// r[0, na + nb) = a * b, r must not overlap with a or b
+		inline void multiply(int_t *r, const int_t *a, size_t na, const int_t *b, size_t nb) noexcept
+		{
+			const size_t nr = na + nb;
+
+			na = kernel::normalized_size(a, na);
+			nb = kernel::normalized_size(b, nb);
+			if (na < nb)
+			{
+				std::swap(a, b);
+				std::swap(na, nb);
+			}
+
+			if (nb == 0)
+			{
+				std::fill(r, r + nr, int_t(0));
+				return;
+			}
+			std::fill(r + na + nb, r + nr, int_t(0));
+
+			if (nb < g_nKaratsubaThreshold)
+				basecase(r, a, na, b, nb);
+			else if (nb >= g_nNttThreshold && ntt::fits(na, nb))
+				ntt::multiply(r, a, na, b, nb);
+			else if (2 * nb <= na + 1)
+				unbalanced(r, a, na, b, nb);
+			else if (nb < g_nToom3Threshold || nb <= 2 * ((na + 2) / 3))
+				karatsuba(r, a, na, b, nb);
+			else
+				toom3(r, a, na, b, nb);
+		}
+	}
+}
@@ -0,0 +1,239 @@
+#pragma once
+
+#include "kernels.h"
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace math
+{
+	// multiplication by number theoretic transforms over three 63 bit primes,
+	// the 64 bit limbs are used as coefficients and recombined via the chinese remainder theorem
+	namespace ntt
+	{
+		// prime field Z/pZ with p = c * 2^k + 1 < 2^63, products are montgomery reduced with R = 2^64
+		struct Field
+		{
+			uint64_t p{}, g{};
+			uint64_t pinv{}; // -p^-1 mod 2^64
+			uint64_t r2{};   // R^2 mod p
+
+		public:
+			Field(const uint64_t p, const uint64_t g) noexcept
+				: p(p), g(g)
+			{
+				uint64_t inv = p;
+				for (int i = 0; i < 5; i++)
+					inv *= 2 - p * inv;
+				pinv = 0 - inv;
+
+				r2 = 1;
+				for (int i = 0; i < 128; i++)
+					r2 = add(r2, r2);
+			}
+
+		public:
+			uint64_t add(const uint64_t a, const uint64_t b) const noexcept
+			{
+				const uint64_t s = a + b;
+				return s >= p ? s - p : s;
+			}
+
+			uint64_t sub(const uint64_t a, const uint64_t b) const noexcept
+			{
+				return a >= b ? a - b : a + p - b;
+			}
+
+			// a * b * R^-1 mod p
+			uint64_t mul(const uint64_t a, const uint64_t b) const noexcept
+			{
+				uint64_t hi, mhi;
+				const uint64_t lo = kernel::mul64(a, b, hi);
+				kernel::mul64(lo * pinv, p, mhi);
+				const uint64_t t = hi + mhi + (lo != 0);
+				return t >= p ? t - p : t;
+			}
+
+			uint64_t toMontgomery(const uint64_t a) const noexcept
+			{
+				return mul(a % p, r2);
+			}
+
+			// works on montgomery representations
+			uint64_t pow(uint64_t base, uint64_t exponent) const noexcept
+			{
+				uint64_t out = mul(1, r2);
+				while (exponent)
+				{
+					if (exponent & 1)
+						out = mul(out, base);
+					base = mul(base, base);
+					exponent >>= 1;
+				}
+				return out;
+			}
+
+			// montgomery representation of a^-1, so mul(x, inverse(a)) = x / a
+			uint64_t inverse(const uint64_t a) const noexcept
+			{
+				return pow(toMontgomery(a), p - 2);
+			}
+		};
+
+		// 2^45 divides p - 1 for all three
+		constexpr size_t nMaxLog2Size = 45;
+
+		inline const std::array<Field, 3> &fields() noexcept
+		{
+			static const std::array<Field, 3> vFields =
+			{
+				Field(0x7fa8000000000001ull, 3),
+				Field(0x7fe1000000000001ull, 3),
+				Field(0x7fffe00000000001ull, 5)
+			};
+			return vFields;
+		}
+
+		class Transform
+		{
+		private:
+			const Field &m_field;
+			size_t m_nSize;
+			std::vector<uint64_t> m_vRoots; // roots of stage len start at index len / 2
+
+		public:
+			Transform(const Field &field, const size_t nSize) noexcept
+				: m_field(field), m_nSize(nSize), m_vRoots(std::max(nSize, size_t(2)))
+			{
+				const uint64_t one = m_field.mul(1, m_field.r2);
+				for (size_t nHalf = 1; nHalf < nSize; nHalf <<= 1)
+				{
+					const uint64_t w = m_field.pow(m_field.toMontgomery(m_field.g), (m_field.p - 1) / (2 * nHalf));
+					m_vRoots[nHalf] = one;
+					for (size_t j = 1; j < nHalf; j++)
+						m_vRoots[nHalf + j] = m_field.mul(m_vRoots[nHalf + j - 1], w);
+				}
+			}
+
+		public:
+			// cyclic transform in place, the output is in natural order
+			void forward(uint64_t *a) const noexcept
+			{
+				for (size_t i = 1, j = 0; i < m_nSize; i++)
+				{
+					size_t bit = m_nSize >> 1;
+					for (; j & bit; bit >>= 1)
+						j ^= bit;
+					j ^= bit;
+					if (i < j)
+						std::swap(a[i], a[j]);
+				}
+
+				for (size_t nHalf = 1; nHalf < m_nSize; nHalf <<= 1)
+				{
+					const uint64_t *pRoots = m_vRoots.data() + nHalf;
+					for (size_t i = 0; i < m_nSize; i += 2 * nHalf)
+					{
+						for (size_t j = 0; j < nHalf; j++)
+						{
+							const uint64_t u = a[i + j];
+							const uint64_t v = m_field.mul(a[i + j + nHalf], pRoots[j]);
+							a[i + j] = m_field.add(u, v);
+							a[i + j + nHalf] = m_field.sub(u, v);
+						}
+					}
+				}
+			}
+
+			// unscaled inverse: the forward transform with mirrored output
+			void inverse(uint64_t *a) const noexcept
+			{
+				forward(a);
+				std::reverse(a + 1, a + m_nSize);
+			}
+		};
+
+		inline bool fits(const size_t na, const size_t nb) noexcept
+		{
+			return na + nb <= (size_t(1) << std::min(nMaxLog2Size, sizeof(size_t) * 8 - 2));
+		}
+
+		// r[0, na + nb) = a * b, r must not overlap with a or b
+		inline void multiply(int_t *r, const int_t *a, const size_t na, const int_t *b, const size_t nb) noexcept
+		{
+			const std::array<Field, 3> &vFields = fields();
+			const bool bSquare = a == b && na == nb;
+			const size_t nr = na + nb;
+			const size_t nCoefficients = nr - 1;
+
+			size_t nSize = 1;
+			while (nSize < nCoefficients)
+				nSize <<= 1;
+
+			std::array<std::vector<uint64_t>, 3> vResidues;
+			std::vector<uint64_t> vB(bSquare ? 0 : nSize);
+
+			for (size_t f = 0; f < vFields.size(); f++)
+			{
+				const Field &field = vFields[f];
+				const Transform transform = Transform(field, nSize);
+
+				std::vector<uint64_t> &vA = vResidues[f];
+				vA.assign(nSize, 0);
+				for (size_t i = 0; i < na; i++)
+					vA[i] = a[i].u64 % field.p;
+				transform.forward(vA.data());
+
+				if (!bSquare)
+				{
+					std::fill(vB.begin(), vB.end(), 0);
+					for (size_t i = 0; i < nb; i++)
+						vB[i] = b[i].u64 % field.p;
+					transform.forward(vB.data());
+				}
+				const uint64_t *pB = bSquare ? vA.data() : vB.data();
+
+				// every product picks up R^-1, the scale R^2 / N undoes that and the 1 / N of the inverse
+				const uint64_t nScale = field.mul(field.inverse(nSize), field.r2);
+				for (size_t i = 0; i < nSize; i++)
+					vA[i] = field.mul(vA[i], pB[i]);
+				transform.inverse(vA.data());
+				for (size_t i = 0; i < nCoefficients; i++)
+					vA[i] = field.mul(vA[i], nScale);
+			}
+
+			// garner: x = r0 + p0 * v1 + p0 * p1 * v2
+			const Field &f0 = vFields[0], &f1 = vFields[1], &f2 = vFields[2];
+			const uint64_t c01 = f1.inverse(f0.p);
+			const uint64_t c02 = f2.inverse(f0.p);
+			const uint64_t c12 = f2.inverse(f1.p);
+
+			int_t p01[2];
+			p01[0] = kernel::mul64(f0.p, f1.p, p01[1].u64);
+
+			int_t acc[3]{};
+			for (size_t i = 0; i < nr; i++)
+			{
+				if (i < nCoefficients)
+				{
+					const uint64_t r0 = vResidues[0][i], r1 = vResidues[1][i], r2 = vResidues[2][i];
+
+					const uint64_t v1 = f1.mul(f1.sub(r1, r0 % f1.p), c01);
+					const uint64_t v2 = f2.mul(f2.sub(f2.mul(f2.sub(r2, r0 % f2.p), c02), v1 % f2.p), c12);
+
+					int_t x[3]{}, y[3]{};
+					x[0] = kernel::mul64(v1, f0.p, x[1].u64);
+					x[2] = kernel::add_1(x, x, 2, r0);
+					y[2] = kernel::mul_1(y, p01, 2, v2);
+					kernel::add_n(x, x, y, 3);
+					kernel::add_n(acc, acc, x, 3);
+				}
+
+				r[i] = acc[0];
+				acc[0] = acc[1];
+				acc[1] = acc[2];
+				acc[2] = 0;
+			}
+		}
+	}
+}
@@ -0,0 +1,487 @@
+#pragma once
+
+#include "kernels.h"
+#include "allocator.h"
+#include "multiplication.h"
+#include "division.h"
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace math
+{
+	// decimal strings of at least this many 19 digit chunks are recombined by divide and conquer
+	inline size_t g_nDecimalParseThreshold = 60;
+
+	// values of at least this many chunks are split by divide and conquer when printed in a base that
+	// is not a power of two, and divisions by powers of at least this many limbs use barrett reduction
+	inline size_t g_nRadixOutputThreshold = 16;
+	inline size_t g_nRadixBarrettThreshold = 40;
+
+	// limbs of cached powers (values and inverses) a thread keeps after printing, larger powers are freed
+	inline size_t g_nRadixPowerCacheLimbs = 1 << 16;
+
+	// conversion between limbs and digit strings
+	namespace radix
+	{
+		constexpr size_t nDecimalChunkDigits = 19;
+		constexpr uint64_t nDecimalChunkBase = 10000000000000000000ULL; // 10^19, the largest power of ten below 2^64
+
+		// value of the character as a digit of radix up to 36, 36 for anything that is not a digit
+		constexpr unsigned digitValue(const char c) noexcept
+		{
+			if (c >= '0' && c <= '9')
+				return unsigned(c - '0');
+			if (c >= 'a' && c <= 'z')
+				return unsigned(c - 'a') + 10;
+			if (c >= 'A' && c <= 'Z')
+				return unsigned(c - 'A') + 10;
+			return 36;
+		}
+
+		// limbs needed for n digits of nDigitBits bits
+		constexpr size_t pow2Limbs(const size_t n, const unsigned nDigitBits) noexcept
+		{
+			return (n * nDigitBits + 63) / 64;
+		}
+
+		// limbs needed for n decimal digits
+		constexpr size_t decimalLimbs(const size_t n) noexcept
+		{
+			return (n + nDecimalChunkDigits - 1) / nDecimalChunkDigits;
+		}
+
+		// r[0, pow2Limbs(n)) = s[0, n) in radix 2^nDigitBits, most significant digit first. nDigitBits has to
+		// divide 64, every limb is assembled in a register. characters outside the radix count as zero like in
+		// the decimal parser, returns false if there was one
+		constexpr bool parsePow2(int_t *r, const char *s, const size_t n, const unsigned nDigitBits) noexcept
+		{
+			const size_t nDigitsPerLimb = 64 / nDigitBits;
+			const unsigned nRadix = 1u << nDigitBits;
+			bool bValid = true;
+
+			size_t nEnd = n;
+			for (size_t i = 0; i < pow2Limbs(n, nDigitBits); i++)
+			{
+				const size_t nBegin = nEnd > nDigitsPerLimb ? nEnd - nDigitsPerLimb : 0;
+
+				uint64_t limb = 0;
+				for (size_t k = nBegin; k < nEnd; k++)
+				{
+					const unsigned nDigit = digitValue(s[k]);
+					bValid &= nDigit < nRadix;
+					limb = limb << nDigitBits | (nDigit < nRadix ? nDigit : 0);
+				}
+
+				r[i].u64 = limb;
+				nEnd = nBegin;
+			}
+
+			return bValid;
+		}
+
+		// r[0, n) = sum of chunk[i] 10^(19 i), horner's scheme with one limb of multiplication per chunk
+		inline void combineBasecase(int_t *r, const int_t *chunk, const size_t n) noexcept
+		{
+			size_t nUsed = 0;
+			for (size_t i = n; i-- != 0;)
+			{
+				r[nUsed].u64 = kernel::mul_1(r, r, nUsed, nDecimalChunkBase);
+				kernel::add_1(r, r, ++nUsed, chunk[i].u64);
+			}
+		}
+
+		// r[0, n) = sum of chunk[i] 10^(19 i). the upper part is combined on its own and multiplied by
+		// vPowers[k] = 10^(19 2^k), where 2^k is the largest power of two below n
+		inline void combine(int_t *r, const int_t *chunk, const size_t n, const memory::vector<memory::vector<int_t>> &vPowers) noexcept
+		{
+			if (n < g_nDecimalParseThreshold)
+				return combineBasecase(r, chunk, n);
+
+			const size_t k = std::bit_width(n - 1) - 1;
+			const size_t nLow = size_t(1) << k;
+			const size_t nHigh = n - nLow;
+			const memory::vector<int_t> &power = vPowers[k];
+
+			memory::vector<int_t> vScratch(nHigh + n, memory::resource());
+			int_t *high = vScratch.data();
+			int_t *product = high + nHigh;
+
+			combine(r, chunk, nLow, vPowers);
+			combine(high, chunk + nLow, nHigh, vPowers);
+			mul::multiply(product, high, nHigh, power.data(), power.size());
+
+			// the lower part is below 10^(19 nLow) and adds to the zero digits of the product
+			mul::addInto(product, n, r, nLow);
+			std::copy(product, product + n, r);
+		}
+
+		// r[0, decimalLimbs(n)) = s[0, n) in decimal. the digits are cut into chunks of 19 that each fit
+		// a limb, which are then combined by divide and conquer. returns false on a non decimal character
+		inline bool parseDecimal(int_t *r, const char *s, const size_t n) noexcept
+		{
+			const size_t nChunks = decimalLimbs(n);
+			if (nChunks == 0)
+				return true;
+
+			bool bValid = true;
+			memory::vector<int_t> vChunks(nChunks, memory::resource());
+			size_t nEnd = n;
+			for (size_t i = 0; i < nChunks; i++)
+			{
+				const size_t nBegin = nEnd > nDecimalChunkDigits ? nEnd - nDecimalChunkDigits : 0;
+
+				uint64_t chunk = 0;
+				for (size_t k = nBegin; k < nEnd; k++)
+				{
+					const unsigned nDigit = digitValue(s[k]);
+					bValid &= nDigit < 10;
+					chunk = chunk * 10 + (nDigit < 10 ? nDigit : 0);
+				}
+
+				vChunks[i].u64 = chunk;
+				nEnd = nBegin;
+			}
+
+			// 10^(19 2^k) for every split level, each one the square of the previous one
+			memory::vector<memory::vector<int_t>> vPowers(memory::resource());
+			if (nChunks >= g_nDecimalParseThreshold)
+			{
+				vPowers.emplace_back(1, int_t(nDecimalChunkBase));
+				while ((size_t(2) << (vPowers.size() - 1)) < nChunks)
+				{
+					const memory::vector<int_t> &previous = vPowers.back();
+					memory::vector<int_t> square(2 * previous.size(), memory::resource());
+					mul::multiply(square.data(), previous.data(), previous.size(), previous.data(), previous.size());
+					square.resize(kernel::normalized_size(square.data(), square.size()));
+					vPowers.push_back(std::move(square));
+				}
+			}
+
+			combine(r, vChunks.data(), nChunks, vPowers);
+			return bValid;
+		}
+
+		constexpr char aDigits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+		// largest power of nBase that fits a limb, C = nBase^nDigits
+		struct ChunkBase
+		{
+			uint64_t C = 1;
+			size_t nDigits = 0;
+
+		public:
+			constexpr explicit ChunkBase(const unsigned nBase) noexcept
+			{
+				while (C <= ~uint64_t(0) / nBase)
+				{
+					C *= nBase;
+					nDigits++;
+				}
+			}
+		};
+
+		// C^(2^j) and, once a division needs it, floor(2^(128 m) / C^(2^j)) for its m limbs
+		struct Power
+		{
+			std::vector<int_t> vValue;
+			std::vector<int_t> vInverse;
+		};
+
+		struct PowerCache
+		{
+			unsigned nBase = 0;
+			std::vector<Power> vPowers;
+		};
+
+		// powers of the chunk base for the last base printed on this thread. they are kept across calls
+		// on the default heap, so they don't depend on the resource that is current while printing.
+		// trimPowers bounds what stays behind
+		inline PowerCache &powerCache() noexcept
+		{
+			thread_local PowerCache cache;
+			return cache;
+		}
+
+		inline std::vector<Power> &powers(const unsigned nBase, const size_t j) noexcept
+		{
+			PowerCache &cache = powerCache();
+			std::vector<Power> &vPowers = cache.vPowers;
+			if (cache.nBase != nBase || vPowers.empty())
+			{
+				vPowers.clear();
+				vPowers.push_back(Power{ { int_t(ChunkBase(nBase).C) }, {} });
+				cache.nBase = nBase;
+			}
+
+			while (vPowers.size() <= j)
+			{
+				const std::vector<int_t> &previous = vPowers.back().vValue;
+				std::vector<int_t> vSquare(2 * previous.size());
+				mul::multiply(vSquare.data(), previous.data(), previous.size(), previous.data(), previous.size());
+				vSquare.resize(kernel::normalized_size(vSquare.data(), vSquare.size()));
+				vPowers.push_back(Power{ std::move(vSquare), {} });
+			}
+
+			return vPowers;
+		}
+
+		// frees the largest cached powers until at most g_nRadixPowerCacheLimbs limbs are left. every
+		// power is twice the size of the one before, so the smaller ones are cheap to keep
+		inline void trimPowers() noexcept
+		{
+			std::vector<Power> &vPowers = powerCache().vPowers;
+			size_t nLimbs = 0;
+			for (const Power &power : vPowers)
+				nLimbs += power.vValue.size() + power.vInverse.size();
+
+			while (vPowers.size() > 1 && nLimbs > g_nRadixPowerCacheLimbs)
+			{
+				nLimbs -= vPowers.back().vValue.size() + vPowers.back().vInverse.size();
+				vPowers.pop_back();
+			}
+		}
+
+		// q[0, na - m + 1) = a / p and r[0, m) = a % p for a[0, na) < p^2 with na >= m >= 2. large powers
+		// are divided by barrett reduction, so that the split costs a few multiplications
+		inline void dividePower(int_t *q, int_t *r, const int_t *a, const size_t na, Power &power) noexcept
+		{
+			const int_t *p = power.vValue.data();
+			const size_t m = power.vValue.size();
+			if (m < g_nRadixBarrettThreshold)
+				return div::divmod(q, r, a, na, p, m);
+
+			if (power.vInverse.empty())
+			{
+				power.vInverse.resize(m + 2);
+				div::reciprocal(power.vInverse.data(), p, m);
+				power.vInverse.resize(kernel::normalized_size(power.vInverse.data(), m + 2));
+			}
+
+			// q estimates a / p from below by at most 2 (HAC 14.42)
+			const int_t *mu = power.vInverse.data();
+			const size_t nMu = power.vInverse.size();
+			const size_t nq = na - m + 1;
+
+			memory::vector<int_t> vScratch((nq + m + 1) + (nq + m) + na, memory::resource());
+			int_t *product = vScratch.data();
+			int_t *back = product + nq + m + 1;
+			int_t *rem = back + nq + m;
+
+			mul::multiply(product, a + (m - 1), nq, mu, nMu);
+			std::copy(product + (m + 1), product + (m + 1) + nq, q);
+
+			mul::multiply(back, q, nq, p, m);
+			kernel::sub_n(rem, a, back, na);
+			while (kernel::normalized_size(rem, na) > m || kernel::cmp(rem, p, m) >= 0)
+			{
+				const uint64_t borrow = kernel::sub_n(rem, rem, p, m);
+				kernel::sub_1(rem + m, rem + m, na - m, borrow);
+				kernel::add_1(q, q, nq, 1);
+			}
+			std::copy(rem, rem + m, r);
+		}
+
+		// out[0, nDigits) = v zero padded
+		inline void writeChunk(char *out, uint64_t v, const unsigned nBase, const size_t nDigits) noexcept
+		{
+			char *p = out + nDigits;
+			if (nBase == 10)
+				while (p != out)
+				{
+					*--p = char('0' + v % 10);
+					v /= 10;
+				}
+			else
+				while (p != out)
+				{
+					*--p = aDigits[v % nBase];
+					v /= nBase;
+				}
+		}
+
+		// out[0, nChunks nDigits) = a[0, na) zero padded for a < C^nChunks, a is used as scratch
+		inline void writePadded(char *out, int_t *a, size_t na, const size_t nChunks, const unsigned nBase) noexcept
+		{
+			const ChunkBase base = ChunkBase(nBase);
+			na = kernel::normalized_size(a, na);
+
+			if (nChunks < g_nRadixOutputThreshold)
+			{
+				const SmallDivisor divisor = SmallDivisor(base.C);
+				for (size_t i = nChunks; i-- != 0;)
+				{
+					const uint64_t chunk = divisor.divrem(a, a, na);
+					na = kernel::normalized_size(a, na);
+					writeChunk(out + i * base.nDigits, chunk, nBase, base.nDigits);
+				}
+				return;
+			}
+
+			// the upper part has at most as many chunks as the lower one, so a < p^2 holds
+			const size_t j = std::bit_width(nChunks - 1) - 1;
+			const size_t nLow = size_t(1) << j;
+			Power &power = powers(nBase, j)[j];
+			const size_t m = power.vValue.size();
+
+			if (na < m)
+			{
+				std::fill(out, out + (nChunks - nLow) * base.nDigits, '0');
+				return writePadded(out + (nChunks - nLow) * base.nDigits, a, na, nLow, nBase);
+			}
+
+			const size_t nq = na - m + 1;
+			memory::vector<int_t> vScratch(nq + m, memory::resource());
+			int_t *q = vScratch.data();
+			int_t *r = q + nq;
+			if (m == 1)
+				r[0].u64 = kernel::divrem_1(q, a, na, power.vValue[0].u64);
+			else
+				dividePower(q, r, a, na, power);
+
+			writePadded(out, q, nq, nChunks - nLow, nBase);
+			writePadded(out + (nChunks - nLow) * base.nDigits, r, m, nLow, nBase);
+		}
+
+		// a[0, n) in radix 2^nDigitBits, read off the bits from the top
+		inline std::to_chars_result toCharsPow2(char *first, char *last, const int_t *a, const size_t n, const unsigned nDigitBits) noexcept
+		{
+			const size_t nBits = n ? 64 * n - std::countl_zero(a[n - 1].u64) : 0;
+			const size_t nChars = std::max<size_t>((nBits + nDigitBits - 1) / nDigitBits, 1);
+			if (size_t(last - first) < nChars)
+				return { last, std::errc::value_too_large };
+
+			const uint64_t mask = (uint64_t(1) << nDigitBits) - 1;
+			for (size_t i = 0; i < nChars; i++)
+			{
+				const size_t nBit = (nChars - 1 - i) * nDigitBits;
+				const size_t nLimb = nBit / 64;
+				const unsigned nOffset = nBit % 64;
+
+				uint64_t v = nLimb < n ? a[nLimb].u64 >> nOffset : 0;
+				if (nOffset + nDigitBits > 64 && nLimb + 1 < n)
+					v |= a[nLimb + 1].u64 << (64 - nOffset);
+				first[i] = aDigits[v & mask];
+			}
+
+			return { first + nChars, std::errc{} };
+		}
+
+		// chunks that hold a value of nBits bits, each chunk carries at least floor(log2 C) bits
+		constexpr size_t chunkCount(const size_t nBits, const ChunkBase &base) noexcept
+		{
+			return std::max<size_t>((nBits + std::bit_width(base.C) - 2) / (std::bit_width(base.C) - 1), 1);
+		}
+
+		// characters toChars needs for a[0, n) to work in place: the exact count for powers of two,
+		// otherwise the zero padded chunks, about nBits / log2(nBase) plus one chunk
+		constexpr size_t maxChars(const int_t *a, size_t n, const unsigned nBase) noexcept
+		{
+			n = kernel::normalized_size(a, n);
+			const size_t nBits = n ? 64 * n - std::countl_zero(a[n - 1].u64) : 0;
+			if (std::has_single_bit(nBase))
+			{
+				const unsigned nDigitBits = std::countr_zero(nBase);
+				return std::max<size_t>((nBits + nDigitBits - 1) / nDigitBits, 1);
+			}
+
+			const ChunkBase base = ChunkBase(nBase);
+			return chunkCount(nBits, base) * base.nDigits;
+		}
+
+		// writes the digits of a[0, n) in base 2 to 36 without leading zeros, like std::to_chars. powers
+		// of two are read off directly. other bases still allocate: a copy of a that the divisions work on,
+		// scratch for the quotients, and a buffer if [first, last) is shorter than maxChars
+		inline std::to_chars_result toChars(char *first, char *last, const int_t *a, size_t n, const unsigned nBase) noexcept
+		{
+			if (nBase < 2 || nBase > 36)
+				return { last, std::errc::invalid_argument };
+
+			n = kernel::normalized_size(a, n);
+			if (std::has_single_bit(nBase))
+				return toCharsPow2(first, last, a, n, std::countr_zero(nBase));
+
+			const ChunkBase base = ChunkBase(nBase);
+			const size_t nBits = n ? 64 * n - std::countl_zero(a[n - 1].u64) : 0;
+			const size_t nChunks = chunkCount(nBits, base);
+			const size_t nPadded = nChunks * base.nDigits;
+
+			memory::vector<int_t> vValue(a, a + n, memory::resource());
+			memory::vector<char> vBuffer(memory::resource());
+			char *out = first;
+			if (size_t(last - first) < nPadded)
+			{
+				vBuffer.resize(nPadded);
+				out = vBuffer.data();
+			}
+
+			writePadded(out, vValue.data(), n, nChunks, nBase);
+			trimPowers();
+
+			const char *pBegin = std::find_if(out, out + nPadded - 1, [](const char c) { return c != '0'; });
+			const size_t nChars = size_t(out + nPadded - pBegin);
+			if (size_t(last - first) < nChars)
+				return { last, std::errc::value_too_large };
+
+			std::memmove(first, pBegin, nChars);
+			return { first + nChars, std::errc{} };
+		}
+
+		// bytes needed for a[0, n), 0 for zero
+		constexpr size_t byteSize(const int_t *a, size_t n) noexcept
+		{
+			n = kernel::normalized_size(a, n);
+			return n ? 8 * n - std::countl_zero(a[n - 1].u64) / 8 : 0;
+		}
+
+		// r[0, ceil(n / 8)) = p[0, n) as base 256 digits in the given byte order
+		inline void fromBytes(int_t *r, const uint8_t *p, const size_t n, const std::endian order) noexcept
+		{
+			const size_t nLimbs = (n + 7) / 8;
+			if (n == 0)
+				return;
+
+			if (order == std::endian::little && std::endian::native == std::endian::little)
+			{
+				r[nLimbs - 1] = 0;
+				std::memcpy(r, p, n);
+				return;
+			}
+
+			for (size_t i = 0; i < nLimbs; i++)
+			{
+				uint64_t limb = 0;
+				for (size_t k = std::min<size_t>(8, n - 8 * i); k-- != 0;)
+				{
+					const size_t nByte = 8 * i + k;
+					limb = limb << 8 | p[order == std::endian::little ? nByte : n - 1 - nByte];
+				}
+				r[i].u64 = limb;
+			}
+		}
+
+		// p[0, nBytes) = a[0, n) zero padded in the given byte order, the value has to fit
+		inline void toBytes(uint8_t *p, const size_t nBytes, const int_t *a, const size_t n, const std::endian order) noexcept
+		{
+			if (nBytes == 0)
+				return;
+
+			if (order == std::endian::little && std::endian::native == std::endian::little)
+			{
+				const size_t nCopy = std::min(nBytes, 8 * n);
+				std::memcpy(p, a, nCopy);
+				std::fill(p + nCopy, p + nBytes, uint8_t(0));
+				return;
+			}
+
+			for (size_t nByte = 0; nByte < nBytes; nByte++)
+			{
+				const uint8_t byte = nByte / 8 < n ? uint8_t(a[nByte / 8].u64 >> (8 * (nByte % 8))) : 0;
+				p[order == std::endian::little ? nByte : nBytes - 1 - nByte] = byte;
+			}
+		}
+	}
+}
@@ -0,0 +1,280 @@
+#pragma once
+
+#include "int_type.h"
+#include "allocator.h"
+#include <algorithm>
+#include <cstddef>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define _BIGINT_SIMD_
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// gcc and clang need the instruction set per function, msvc allows the intrinsics everywhere
+#if defined(__GNUC__) || defined(__clang__)
+#define BIGINT_TARGET(features) __attribute__((target(features)))
+#else
+#define BIGINT_TARGET(features)
+#endif
+
+namespace math
+{
+	// smallest operand (in limbs) for which mul::basecase uses the ifma kernel
+	inline size_t g_nSimdBasecaseThreshold = 12;
+
+	// smallest modulus (in limbs) for which MontgomeryContext::powmod switches to the ifma kernel
+	inline size_t g_nIfmaMontgomeryThreshold = 16;
+
+	// vectorized kernels for x86-64, chosen once at runtime from cpuid. products are computed on
+	// digits of less than 64 bits, so that the column sums can be accumulated without carries.
+	// there is only an avx-512 ifma path, without it the scalar kernels run. avx2 has no 64 bit
+	// multiply and a vpmuludq version lost to the mulx loop below the karatsuba threshold
+	namespace simd
+	{
+		struct CpuFeatures
+		{
+			bool bAvx512Ifma = false;
+		};
+
+		inline CpuFeatures detectCpuFeatures() noexcept
+		{
+			CpuFeatures features;
+
+#ifdef _BIGINT_SIMD_
+			unsigned int regs[4]{};
+			const auto cpuid = [&regs](const unsigned int nLeaf)
+			{
+#if defined(_MSC_VER)
+				__cpuidex(reinterpret_cast<int *>(regs), nLeaf, 0);
+#else
+				__cpuid_count(nLeaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+			};
+
+			cpuid(0);
+			if (regs[0] < 7)
+				return features;
+
+			// the os has to save the vector registers, otherwise the instructions fault
+			cpuid(1);
+			if ((regs[2] & (1u << 27)) == 0)
+				return features;
+
+#if defined(_MSC_VER)
+			const uint64_t xcr0 = _xgetbv(0);
+#else
+			uint32_t xcr0Low, xcr0High;
+			__asm__("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+			const uint64_t xcr0 = uint64_t(xcr0High) << 32 | xcr0Low;
+#endif
+			const bool bZmmState = (xcr0 & 0xe6) == 0xe6;
+
+			cpuid(7);
+			features.bAvx512Ifma = bZmmState && (regs[1] & (1u << 16)) && (regs[1] & (1u << 21));
+#endif
+
+			return features;
+		}
+
+		inline const CpuFeatures &cpu() noexcept
+		{
+			static const CpuFeatures features = detectCpuFeatures();
+			return features;
+		}
+
+		// splits a[0, n) into nDigits digits of nDigitBits bits each
+		inline void toDigits(uint64_t *d, const size_t nDigits, const int_t *a, const size_t n, const unsigned nDigitBits) noexcept
+		{
+			const uint64_t mask = (uint64_t(1) << nDigitBits) - 1;
+			for (size_t k = 0; k < nDigits; k++)
+			{
+				const size_t nBit = k * nDigitBits;
+				const size_t nLimb = nBit / 64;
+				const unsigned nOffset = nBit % 64;
+
+				uint64_t v = nLimb < n ? a[nLimb].u64 >> nOffset : 0;
+				if (nOffset + nDigitBits > 64 && nLimb + 1 < n)
+					v |= a[nLimb + 1].u64 << (64 - nOffset);
+				d[k] = v & mask;
+			}
+		}
+
+		// r[0, nr) = sum of column[k] 2^(nDigitBits k), the sum has to fit into nr limbs.
+		// the columns may exceed nDigitBits bits as long as adding a carry does not overflow
+		inline void fromColumns(int_t *r, const size_t nr, const uint64_t *column, const size_t nColumns, const unsigned nDigitBits) noexcept
+		{
+			const uint64_t mask = (uint64_t(1) << nDigitBits) - 1;
+			uint64_t carry = 0, current = 0;
+			unsigned nFill = 0;
+			size_t i = 0;
+
+			for (size_t k = 0; i < nr && (k < nColumns || carry); k++)
+			{
+				const uint64_t t = (k < nColumns ? column[k] : 0) + carry;
+				const uint64_t digit = t & mask;
+				carry = t >> nDigitBits;
+
+				current |= digit << nFill;
+				nFill += nDigitBits;
+				if (nFill >= 64)
+				{
+					r[i++] = current;
+					nFill -= 64;
+					current = nFill ? digit >> (nDigitBits - nFill) : 0;
+				}
+			}
+
+			if (i < nr)
+				r[i++] = current;
+			std::fill(r + i, r + nr, int_t(0));
+		}
+
+#ifdef _BIGINT_SIMD_
+		// column sums of a * b on 52 bit digits: the low halves of a_i b_j go to column i + j, the high
+		// halves to column i + j + 1. b has to be padded with 8 zero digits on both sides. every group of
+		// 8 columns stays in two registers while all contributing digits of a stream past it
+		BIGINT_TARGET("avx512f,avx512ifma")
+		inline void columnsIfma(uint64_t *column, const size_t nColumns, const uint64_t *a, const size_t na, const uint64_t *b, const size_t nb) noexcept
+		{
+			for (size_t k = 0; k < nColumns; k += 8)
+			{
+				__m512i lo = _mm512_setzero_si512();
+				__m512i hi = _mm512_setzero_si512();
+
+				const size_t nFirst = k > nb ? k - nb : 0;
+				const size_t nLast = std::min(na, k + 8);
+				for (size_t i = nFirst; i < nLast; i++)
+				{
+					const __m512i ai = _mm512_set1_epi64(a[i]);
+					const ptrdiff_t nOffset = ptrdiff_t(k) - ptrdiff_t(i);
+					lo = _mm512_madd52lo_epu64(lo, ai, _mm512_loadu_si512(b + nOffset));
+					hi = _mm512_madd52hi_epu64(hi, ai, _mm512_loadu_si512(b + nOffset - 1));
+				}
+
+				_mm512_storeu_si512(column + k, _mm512_add_epi64(lo, hi));
+			}
+		}
+
+		// almost montgomery multiplication on 52 bit digits with R = 2^(416 nVectors), nInverse = -n^-1 mod 2^52.
+		// for a, b < 2n and 4n < R the product r = a b R^-1 mod n is below 2n but not necessarily below n.
+		// a, b and n stay in registers, the accumulator is only normalized at the end. r may alias a or b
+		template <size_t nVectors>
+		BIGINT_TARGET("avx512f,avx512ifma")
+		inline void montMulIfma(uint64_t *r, const uint64_t *a, const uint64_t *b, const uint64_t *n, const uint64_t nInverse) noexcept
+		{
+			constexpr uint64_t mask = (uint64_t(1) << 52) - 1;
+
+			__m512i va[nVectors], vn[nVectors], acc[nVectors];
+			for (size_t v = 0; v < nVectors; v++)
+			{
+				va[v] = _mm512_loadu_si512(a + 8 * v);
+				vn[v] = _mm512_loadu_si512(n + 8 * v);
+				acc[v] = _mm512_setzero_si512();
+			}
+
+			for (size_t i = 0; i < 8 * nVectors; i++)
+			{
+				const __m512i bi = _mm512_set1_epi64(b[i]);
+				for (size_t v = 0; v < nVectors; v++)
+					acc[v] = _mm512_madd52lo_epu64(acc[v], va[v], bi);
+
+				// y n clears the lowest digit, which then leaves the accumulator with its carry
+				const uint64_t y = (_mm_cvtsi128_si64(_mm512_castsi512_si128(acc[0])) * nInverse) & mask;
+				const __m512i vy = _mm512_set1_epi64(y);
+				for (size_t v = 0; v < nVectors; v++)
+					acc[v] = _mm512_madd52lo_epu64(acc[v], vn[v], vy);
+
+				const uint64_t carry = uint64_t(_mm_cvtsi128_si64(_mm512_castsi512_si128(acc[0]))) >> 52;
+				for (size_t v = 0; v + 1 < nVectors; v++)
+					acc[v] = _mm512_alignr_epi64(acc[v + 1], acc[v], 1);
+				acc[nVectors - 1] = _mm512_alignr_epi64(_mm512_setzero_si512(), acc[nVectors - 1], 1);
+				acc[0] = _mm512_mask_add_epi64(acc[0], 1, acc[0], _mm512_set1_epi64(carry));
+
+				// the high halves belong one digit further up, which is where the shift just moved everything
+				for (size_t v = 0; v < nVectors; v++)
+				{
+					acc[v] = _mm512_madd52hi_epu64(acc[v], va[v], bi);
+					acc[v] = _mm512_madd52hi_epu64(acc[v], vn[v], vy);
+				}
+			}
+
+			alignas(64) uint64_t column[8 * nVectors];
+			for (size_t v = 0; v < nVectors; v++)
+				_mm512_store_si512(column + 8 * v, acc[v]);
+
+			uint64_t carry = 0;
+			for (size_t k = 0; k < 8 * nVectors; k++)
+			{
+				const uint64_t t = column[k] + carry;
+				r[k] = t & mask;
+				carry = t >> 52;
+			}
+		}
+#endif
+
+		// largest modulus for montMul, 4n < R has to hold
+		constexpr size_t nMaxMontVectors = 10;
+
+		// vectors of 8 digits needed for a montgomery modulus of nBits bits
+		constexpr size_t montVectors(const size_t nBits) noexcept
+		{
+			return (nBits + 2 + 8 * 52 - 1) / (8 * 52);
+		}
+
+		// montMulIfma for a width known at runtime
+		inline void montMul(const size_t nVectors, uint64_t *r, const uint64_t *a, const uint64_t *b, const uint64_t *n, const uint64_t nInverse) noexcept
+		{
+#ifdef _BIGINT_SIMD_
+			switch (nVectors)
+			{
+			case 1:  return montMulIfma<1>(r, a, b, n, nInverse);
+			case 2:  return montMulIfma<2>(r, a, b, n, nInverse);
+			case 3:  return montMulIfma<3>(r, a, b, n, nInverse);
+			case 4:  return montMulIfma<4>(r, a, b, n, nInverse);
+			case 5:  return montMulIfma<5>(r, a, b, n, nInverse);
+			case 6:  return montMulIfma<6>(r, a, b, n, nInverse);
+			case 7:  return montMulIfma<7>(r, a, b, n, nInverse);
+			case 8:  return montMulIfma<8>(r, a, b, n, nInverse);
+			case 9:  return montMulIfma<9>(r, a, b, n, nInverse);
+			case 10: return montMulIfma<10>(r, a, b, n, nInverse);
+			}
+#endif
+		}
+
+		// r[0, na + nb) = a * b on the ifma units; returns false if the cpu has none
+		inline bool basecase(int_t *r, const int_t *a, const size_t na, const int_t *b, const size_t nb) noexcept
+		{
+#ifdef _BIGINT_SIMD_
+			// up to 64 limbs a column sum stays far below 2^64, karatsuba takes over long before
+			const size_t nMin = std::min(na, nb);
+			if (!cpu().bAvx512Ifma || nMin < g_nSimdBasecaseThreshold || nMin > 64)
+				return false;
+
+			constexpr unsigned nDigitBits = 52;
+			const size_t nDigitsA = (na * 64 + nDigitBits - 1) / nDigitBits;
+			const size_t nDigitsB = (nb * 64 + nDigitBits - 1) / nDigitBits;
+			const size_t nColumns = (nDigitsA + nDigitsB + 7) / 8 * 8;
+
+			// b gets 8 zero digits of padding on both sides
+			memory::vector<uint64_t> vDigits(nDigitsA + (nDigitsB + 16) + nColumns, memory::resource());
+			uint64_t *da = vDigits.data();
+			uint64_t *db = da + nDigitsA + 8;
+			uint64_t *column = db + nDigitsB + 8;
+			toDigits(da, nDigitsA, a, na, nDigitBits);
+			toDigits(db, nDigitsB, b, nb, nDigitBits);
+
+			columnsIfma(column, nColumns, da, nDigitsA, db, nDigitsB);
+
+			fromColumns(r, na + nb, column, nColumns, nDigitBits);
+			return true;
+#else
+			return false;
+#endif
+		}
+	}
+}